@@ -0,0 +1,49 @@
+# Embeds compiled kernels in a C++ source: one constexpr array of SPIR-V words per kernel, and kernelTable
+# listing them sorted by name (for the binary search of getEmbeddedKernel)
+# Usage: cmake -DOUTPUT=<file> -P EmbedKernels.cmake -- <kernel.spv>...
+
+set(SPIRV_FILES)
+set(FOUND_SEPARATOR FALSE)
+math(EXPR LAST_ARG "${CMAKE_ARGC} - 1")
+foreach(I RANGE ${LAST_ARG})
+	if(FOUND_SEPARATOR)
+		list(APPEND SPIRV_FILES ${CMAKE_ARGV${I}})
+	elseif(CMAKE_ARGV${I} STREQUAL "--")
+		set(FOUND_SEPARATOR TRUE)
+	endif()
+endforeach()
+
+# Kernel names only use [a-z0-9_], which all sort after '.': sorting the file names sorts the kernel names
+list(SORT SPIRV_FILES)
+
+set(ARRAYS "")
+set(TABLE "")
+foreach(SPIRV ${SPIRV_FILES})
+	get_filename_component(NAME ${SPIRV} NAME_WE)
+
+	# Validate the module: whole words, little endian magic number
+	file(READ ${SPIRV} HEX_CONTENT HEX)
+	string(LENGTH "${HEX_CONTENT}" HEX_LENGTH)
+	math(EXPR REMAINDER "${HEX_LENGTH} % 8")
+	if(HEX_LENGTH LESS 40 OR NOT REMAINDER EQUAL 0)
+		message(FATAL_ERROR "Invalid SPIR-V size for kernel ${NAME}")
+	endif()
+	string(SUBSTRING "${HEX_CONTENT}" 0 8 MAGIC)
+	if(NOT MAGIC STREQUAL "03022307")
+		message(FATAL_ERROR "Invalid SPIR-V magic number for kernel ${NAME}")
+	endif()
+
+	# Bytes -> 32 bit words, 8 per line
+	string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," WORDS "${HEX_CONTENT}")
+	string(REGEX REPLACE "((0x[0-9a-f]+,)(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?(0x[0-9a-f]+,)?)" "\t\\1\n" WORDS "${WORDS}")
+	string(REPLACE ",0x" ", 0x" WORDS "${WORDS}")
+
+	string(APPEND ARRAYS "constexpr uint32_t kernel_${NAME}[] = {\n${WORDS}};\n\n")
+	string(APPEND TABLE "\t{ \"${NAME}\", kernel_${NAME} },\n")
+endforeach()
+
+set(CONTENT "// Generated by EmbedKernels.cmake from the compiled kernels, do not edit\n\n")
+string(APPEND CONTENT "namespace {\n\n${ARRAYS}}\n\n")
+string(APPEND CONTENT "constexpr EmbeddedKernel kernelTable[] = {\n${TABLE}};\n")
+
+file(WRITE ${OUTPUT} "${CONTENT}")
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Tensor.hpp"
+#include "Random.hpp"
+
+#include <cstdint>
+
+
+
+// Operation codes (the values are shared with the compute kernels)
+enum class BinaryOp : uint32_t {
+	Add = 0,
+	Sub = 1,
+	Mul = 2,
+	Div = 3,
+};
+
+enum class UnaryOp : uint32_t {
+	Relu = 0,
+	Neg = 1,
+	Exp = 2,
+	Scale = 3,	// x * alpha
+};
+
+
+enum class BackendType {
+	Cpu,
+	Vulkan,
+};
+
+
+// Tensor operations implemented by a backend
+// Inputs and outputs are already allocated at the location expected by the backend
+// Operands share the dtype of the output (except for convert), 16-bit dtypes are computed in float32
+// The operands of binary are contiguous and broadcast to the shape of the output (see BroadcastLayout)
+class Backend {
+public:
+	virtual ~Backend() = default;
+
+	virtual BackendType getType() const = 0;
+
+	virtual void binary(BinaryOp op, const Tensor& a, const Tensor& b, Tensor& out) = 0;
+	virtual void unary(UnaryOp op, const Tensor& a, Tensor& out, float alpha = 1.0f) = 0;
+	virtual void matmul(const Tensor& a, const Tensor& b, Tensor& out) = 0;
+	virtual void convert(const Tensor& a, Tensor& out) = 0;		// To the dtype of out
+
+	// Counter-based random values, optionally fused with a binary op: out = a <op> (alpha * random)
+	virtual void random(const RandomSpec& spec, Tensor& out) = 0;
+	virtual void randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha, Tensor& out) = 0;
+};
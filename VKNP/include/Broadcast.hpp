@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define MAX_BROADCAST_RANK 6	// Rank left after collapsing, limited by the push constants of the strided kernels
+
+
+
+// Shape of an elementwise operation between two shapes (NumPy rules), throws if they are incompatible
+std::vector<size_t> broadcastShapes(const std::vector<size_t>& a, const std::vector<size_t>& b);
+
+
+// Addressing of two contiguous operands read with the shape of the output, without expanding them in memory
+// Broadcast dimensions get a zero stride, and consecutive dimensions are merged when both operands allow it
+// (e.g. a bias add [N, H, W] + [W] becomes [N * H, W] with strides (W, 1) and (0, 1))
+struct BroadcastLayout {
+	std::vector<size_t> shape;		// Collapsed output shape, innermost dimension last (at least one dimension)
+	std::vector<size_t> stridesA;	// In elements
+	std::vector<size_t> stridesB;
+
+	static BroadcastLayout create(const std::vector<size_t>& shapeA, const std::vector<size_t>& shapeB,
+								  const std::vector<size_t>& outShape);
+
+	size_t getRank() const { return shape.size(); }
+	size_t getInnerSize() const { return shape.back(); }
+
+	// Both operands have the layout of the output: plain elementwise loop
+	bool isContiguous() const { return shape.size() == 1 && stridesA[0] == 1 && stridesB[0] == 1; }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Backend.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <deque>
+#include <mutex>
+
+
+
+// Instruction sets used by the CPU kernels, detected at runtime
+enum class SimdLevel {
+	Scalar,
+	Neon,
+	Avx2,		// AVX2 + FMA
+	Avx512,		// AVX-512F
+};
+
+const char* getSimdLevelName(SimdLevel level);
+
+
+// Host backend: vectorized kernels spread over a pool of worker threads
+// Used as a fallback when no Vulkan device is available, and for the tensors too small to amortize a submission
+class CpuBackend : public Backend {
+public:
+	// threadCount == 0 -> one thread per hardware thread
+	explicit CpuBackend(uint32_t threadCount = 0);
+	~CpuBackend() override;
+
+	CpuBackend(const CpuBackend&) = delete;
+	CpuBackend& operator=(const CpuBackend&) = delete;
+
+	BackendType getType() const override { return BackendType::Cpu; }
+
+	void binary(BinaryOp op, const Tensor& a, const Tensor& b, Tensor& out) override;
+	void unary(UnaryOp op, const Tensor& a, Tensor& out, float alpha = 1.0f) override;
+	void matmul(const Tensor& a, const Tensor& b, Tensor& out) override;
+	void convert(const Tensor& a, Tensor& out) override;
+	void random(const RandomSpec& spec, Tensor& out) override;
+	void randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha, Tensor& out) override;
+
+	// SIMD level: can be lowered for testing, never raised above what the CPU supports
+	static SimdLevel detectSimdLevel();
+	static bool isSimdLevelSupported(SimdLevel level);
+	SimdLevel getSimdLevel() const { return simdLevel; }
+	void setSimdLevel(SimdLevel level);
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()) + 1; }
+
+	// Split [0, count) in chunks of at least grainSize elements, run by the workers and the calling thread
+	void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task);
+
+private:
+	void workerLoop();
+
+private:
+	SimdLevel simdLevel;
+
+	// Thread pool
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex taskMutex;
+	std::condition_variable taskCondition;
+	bool stopping = false;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+
+// Element types (the values are shared with the compute kernels)
+enum class DType : uint32_t {
+	Float32 = 0,
+	Float16 = 1,	// IEEE 754 half precision
+	BFloat16 = 2,	// Upper half of a float32
+};
+
+size_t getDTypeSize(DType dtype);
+const char* getDTypeName(DType dtype);
+
+// Compute kernels are compiled once per dtype: <kernel>_<name>
+const char* getDTypeSuffix(DType dtype);
+
+
+// Scalar conversions (round to nearest even)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+uint16_t floatToBFloat16(float value);
+float bfloat16ToFloat(uint16_t value);
+
+// Bulk conversions between any dtype and float32 (vectorized when the CPU supports F16C)
+void convertToFloat(DType dtype, const void* src, float* dst, size_t count);
+void convertFromFloat(DType dtype, const float* src, void* dst, size_t count);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Backend.hpp"
+#include "CpuBackend.hpp"
+#include "VulkanBackend.hpp"
+#include "Tensor.hpp"
+#include "ShardedTensor.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+
+
+enum class BackendPreference {
+	Auto,		// Pick the cheapest backend according to the cost model
+	Cpu,
+	Vulkan,
+};
+
+
+// Rough throughput figures used to choose a backend for each operation
+// The defaults are conservative, the crossover benchmark gives the values for a given machine
+struct CostModel {
+	size_t minDeviceElements = 1 << 12;		// Below this size, always run on the CPU
+	double deviceLaunchLatency = 50e-6;		// Seconds per submission (record + submit + fence wait)
+	double deviceBandwidth = 100e9;			// Bytes per second
+	double deviceFlops = 1e12;
+	double cpuBandwidth = 10e9;
+	double cpuFlops = 50e9;
+	double transferBandwidth = 8e9;			// Host <-> device copies
+
+	// bytes: memory traffic of the operation, hostBytes: part of the inputs to upload to run on the GPU
+	double estimateCpu(double bytes, double flops, double deviceBytes) const;
+	double estimateDevice(double bytes, double flops, double hostBytes) const;
+};
+
+
+// Entry point of the tensor operations: routes each operation to the CPU or Vulkan backend
+class Dispatcher {
+public:
+	// Singleton access
+	static Dispatcher& getDispatcher();
+
+	// Explicit constructors and destructors for the singleton
+	// Falls back to the CPU backend if no Vulkan device is available
+	void init();
+	void destroy();
+
+	bool hasVulkan() const { return vulkanBackend != nullptr; }
+	CpuBackend& getCpuBackend();
+
+	// Backend selection
+	void setPreference(BackendPreference preference);
+	void setCostModel(const CostModel& model);
+	const CostModel& getCostModel() const { return costModel; }
+	BackendType getLastBackend() const { return lastBackend; }
+
+	// Operations (elementwise operations require identical dtypes, the shapes are broadcast with the NumPy rules)
+	Tensor add(const Tensor& a, const Tensor& b);
+	Tensor sub(const Tensor& a, const Tensor& b);
+	Tensor mul(const Tensor& a, const Tensor& b);
+	Tensor div(const Tensor& a, const Tensor& b);
+
+	Tensor relu(const Tensor& a);
+	Tensor neg(const Tensor& a);
+	Tensor exp(const Tensor& a);
+	Tensor scale(const Tensor& a, float alpha);
+
+	Tensor matmul(const Tensor& a, const Tensor& b);
+
+	// dtype conversion (returns a view if the tensor already has the requested dtype)
+	Tensor cast(const Tensor& a, DType dtype);
+
+	// Random tensors (see RandomSpec), generated directly where they live: no upload for device tensors
+	Tensor random(const std::vector<size_t>& shape, const RandomSpec& spec, TensorLocation location,
+				  uint32_t deviceIndex = 0, DType dtype = DType::Float32);
+
+	// Fused with an elementwise op: a <op> (alpha * random), without materializing the random tensor
+	Tensor randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha = 1.0f);
+	Tensor dropout(const Tensor& a, float probability, uint64_t seed, uint64_t offset = 0);		// Scaled by 1 / (1 - p)
+
+	// Sharded operations: each shard runs with the Vulkan backend on its device, all the devices concurrently
+	// Elementwise operations require aligned operands, partial results only support the linear ones
+	ShardedTensor add(const ShardedTensor& a, const ShardedTensor& b);
+	ShardedTensor sub(const ShardedTensor& a, const ShardedTensor& b);
+	ShardedTensor mul(const ShardedTensor& a, const ShardedTensor& b);
+	ShardedTensor div(const ShardedTensor& a, const ShardedTensor& b);
+
+	ShardedTensor relu(const ShardedTensor& a);
+	ShardedTensor neg(const ShardedTensor& a);
+	ShardedTensor exp(const ShardedTensor& a);
+	ShardedTensor scale(const ShardedTensor& a, float alpha);
+
+	// Rows split x replicated -> rows split, replicated x columns split -> columns split,
+	// inner dimension split on both sides -> partial sums (to be reduced with allReduce)
+	ShardedTensor matmul(const ShardedTensor& a, const ShardedTensor& b);
+
+	// Collectives staged through the host, the results are replicated on the devices of the input
+	ShardedTensor allReduce(const ShardedTensor& partials);		// Sum of the partial results, accumulated in float32
+	ShardedTensor allGather(const ShardedTensor& tensor);		// Concatenation of the slices
+
+private:
+	// Singleton: private constructor and destructor
+	Dispatcher() = default;
+	~Dispatcher() = default;
+
+	// Singleton: no copy or assignment
+	Dispatcher(const Dispatcher&) = delete;
+	Dispatcher& operator=(const Dispatcher&) = delete;
+
+	// Internal methods to pick a backend and move the operands
+	Backend& selectBackend(const std::vector<const Tensor*>& inputs, DType outputDType, size_t outputElements, double flops);
+	uint32_t selectDevice(const std::vector<const Tensor*>& inputs) const;
+	Tensor runBinary(BinaryOp op, const Tensor& a, const Tensor& b);
+	Tensor runUnary(UnaryOp op, const Tensor& a, float alpha);
+
+	VulkanBackend& selectShardBackend(const std::vector<const ShardedTensor*>& inputs);
+	ShardedTensor runShardedBinary(BinaryOp op, const ShardedTensor& a, const ShardedTensor& b);
+	ShardedTensor runShardedUnary(UnaryOp op, const ShardedTensor& a, float alpha);
+
+private:
+	std::unique_ptr<CpuBackend> cpuBackend;
+	std::unique_ptr<VulkanBackend> vulkanBackend;
+
+	BackendPreference preference = BackendPreference::Auto;
+	CostModel costModel;
+	std::atomic<BackendType> lastBackend = BackendType::Cpu;	// Written under dispatcherMutex, read by getLastBackend without it
+
+	// Mutex to protect the configuration
+	std::mutex dispatcherMutex;
+};
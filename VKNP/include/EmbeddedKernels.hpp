@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+
+
+// SPIR-V of a compute kernel, compiled at build time and embedded in the library
+struct EmbeddedKernel {
+	std::string_view name;
+	std::span<const uint32_t> code;
+};
+
+// All the kernels, sorted by name
+std::span<const EmbeddedKernel> getEmbeddedKernels();
+
+// Throws if the kernel doesn't exist
+std::span<const uint32_t> getEmbeddedKernel(std::string_view name);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "VulkanContext.hpp"
+#include "MemoryManager.hpp"
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <map>
+#include <mutex>
+
+#define MAX_PUSH_CONSTANTS_SIZE 128		// Minimum guaranteed by the Vulkan specification
+
+
+
+// One kernel of a batch recorded in a single command buffer
+struct KernelLaunch {
+	std::string kernelName;
+	std::vector<MemoryHandle> buffers;					// Bound to the bindings 0..n-1 of the descriptor set 0
+	std::vector<uint32_t> specializationConstants;		// Values of the constant_id 0..n-1 (one pipeline per set of values)
+	std::array<std::byte, MAX_PUSH_CONSTANTS_SIZE> pushConstants{};
+	uint32_t pushConstantsSize = 0;
+	uint32_t groupCount[3] = { 1, 1, 1 };
+
+	template <typename T>
+	void setPushConstants(const T& params) {
+		static_assert(sizeof(T) <= MAX_PUSH_CONSTANTS_SIZE, "Push constants exceed the guaranteed size");
+		std::memcpy(pushConstants.data(), &params, sizeof(T));
+		pushConstantsSize = sizeof(T);
+	}
+};
+
+
+// Compute pipelines, built lazily from the SPIR-V kernels for each device
+class KernelManager {
+public:
+	// Singleton access
+	static KernelManager& getManager();
+
+	// Explicit constructors and destructors for the singleton (same reasons as the MemoryManager)
+	void init(VulkanContext* context);
+	void destroy();
+
+	// Run a kernel and wait for its completion
+	// The buffers are bound to the bindings 0..n-1 of the descriptor set 0
+	void dispatch(uint32_t deviceIndex, const std::string& kernelName, const std::vector<MemoryHandle>& buffers,
+				  const void* pushConstants, uint32_t pushConstantsSize,
+				  uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+	// Run several kernels in order in one submission, each one seeing the results of the previous ones
+	// Multi-pass algorithms pay for a single submission and wait instead of one per pass
+	void dispatchBatch(uint32_t deviceIndex, const std::vector<KernelLaunch>& launches);
+
+	// Number of workgroups for a 1D kernel using a grid-stride loop
+	static uint32_t getGroupCount(size_t elementCount, uint32_t workgroupSize);
+
+private:
+	// Singleton: private constructor and destructor
+	KernelManager() = default;
+	~KernelManager() = default;
+
+	// Singleton: no copy or assignment
+	KernelManager(const KernelManager&) = delete;
+	KernelManager& operator=(const KernelManager&) = delete;
+
+	struct Kernel {
+		VkDevice device;
+		VkShaderModule module;
+		VkDescriptorSetLayout setLayout;
+		VkPipelineLayout pipelineLayout;
+		VkPipeline pipeline;
+		uint32_t bindingCount;
+	};
+
+	// Internal methods to build and destroy the pipelines
+	Kernel& getKernel(uint32_t deviceIndex, const std::string& kernelName, uint32_t bindingCount,
+					  const std::vector<uint32_t>& specializationConstants);
+	void destroyKernel(Kernel& kernel);
+
+private:
+	VulkanContext* vkContext = nullptr;
+
+	// Map (device, kernel name, specialization constants) -> Kernel
+	std::map<std::tuple<uint32_t, std::string, std::vector<uint32_t>>, Kernel> kernels;
+
+	// Mutex to protect the kernel cache
+	std::mutex kernelMutex;
+};
@@ -4,7 +4,9 @@
 
 #include <vulkan/vulkan.h>
 #include <unordered_map>
+#include <chrono>
 #include <cstdint>
+#include <map>
 #include <vector>
 #include <memory>
 #include <deque>
@@ -19,7 +21,38 @@ struct MemoryHandle {
 
 
 // Structure to store the information to transfer to the compute pipeline
-struct BufferInfo {};	// ToDo
+// The VkBuffer may change after a defragmentation including the active allocations, it must be fetched again before recording commands
+struct BufferInfo {
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+	uint32_t deviceIndex = 0;
+};
+
+
+// Fragmentation of the sub-allocated device memory
+struct FragmentationStats {
+	uint32_t blockCount = 0;
+	VkDeviceSize reservedBytes = 0;		// Total size of the memory blocks
+	VkDeviceSize usedBytes = 0;			// Bytes used by active and cached allocations
+	VkDeviceSize freeBytes = 0;			// Free gaps inside the blocks
+	VkDeviceSize largestFreeRange = 0;
+
+	// 0 -> all the free memory is contiguous, close to 1 -> free memory scattered in small gaps
+	double fragmentation() const {
+		return freeBytes == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeRange) / static_cast<double>(freeBytes);
+	}
+};
+
+
+// Result of a (possibly partial) defragmentation pass
+struct DefragmentationReport {
+	FragmentationStats before;
+	FragmentationStats after;
+	uint32_t movedAllocations = 0;
+	VkDeviceSize movedBytes = 0;
+	uint32_t releasedBlocks = 0;
+	bool complete = false;	// False if the time budget expired before all the blocks were processed
+};
 
 
 class MemoryManager {
@@ -38,12 +71,29 @@ public:
 	void acquireBuffer(const MemoryHandle& handle);
 	void releaseBuffer(const MemoryHandle& handle);
 
-	// Cache management
+	// Cache management (0 bytes -> the whole cache)
 	void emptyCache(VkDeviceSize bytesToFree = 0);
+	void emptyCache(VkDeviceSize bytesToFree, uint32_t deviceIndex);	// Only evicts the buffers of this device
+
+	// Defragmentation: relocates the cached allocations out of sparsely used blocks and releases the emptied blocks
+	// includeActive also relocates the allocations in use: the BufferInfo previously returned for them becomes invalid
+	// A zero time budget runs until completion, otherwise the pass stops once it is exceeded (after releasing at least one block)
+	// getBuffer only compacts the cached allocations when the device is full, the gaps between active ones need includeActive
+	DefragmentationReport defragment(uint32_t deviceIndex, std::chrono::microseconds timeBudget = std::chrono::microseconds::zero(),
+									 bool includeActive = false);
+	FragmentationStats getFragmentationStats(uint32_t deviceIndex) const;
+
+	// Data transfers (through a host-visible staging buffer)
+	void writeBuffer(const MemoryHandle& handle, const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+	void readBuffer(const MemoryHandle& handle, void* data, VkDeviceSize size, VkDeviceSize offset = 0);
 
 	// Getters (required for descriptor creation)
 	BufferInfo getBufferInfo(const MemoryHandle& handle) const;
 
+	// Keeps the handle -> VkBuffer mapping stable while commands using the buffers are recorded and submitted
+	// Relocations are ordered after the submitted commands, waiting for their completion doesn't need the lock
+	std::unique_lock<std::recursive_mutex> lockBuffers() { return std::unique_lock<std::recursive_mutex>(managerMutex); }
+
 private:
 	// Singleton: private constructor and destructor
 	MemoryManager() = default;
@@ -57,19 +107,51 @@ private:
 	MemoryHandle createAllocation(VkDeviceSize size, uint32_t deviceIndex);
 	void destroyAllocation(uint64_t allocId, bool inCache);
 
+	// Sub-allocation inside memory blocks
+	struct MemoryBlock;
+	bool placeInBlock(MemoryBlock& block, const VkMemoryRequirements& requirements, VkDeviceSize& offset);
+	void freeRange(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
+	uint64_t createBlock(uint32_t deviceIndex, uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated);
+	void destroyBlock(uint64_t blockId);
+	VkDeviceSize getFreeGapsSize(uint32_t deviceIndex) const;
+	VkDeviceSize getFreeDeviceMemory(uint32_t deviceIndex) const;
+	void reclaimDeviceMemory(uint32_t deviceIndex, VkDeviceSize size);
+
 private:
 	// Allocation information
 	struct AllocationInfo {
 		uint64_t id;
 		VkBuffer buffer;
-		VkDeviceMemory memory;
 		VkDevice device;
 		VkDeviceSize size;
 		uint32_t deviceIndex;
 
+		// Location inside the memory block
+		uint64_t blockId;
+		VkDeviceSize offset;
+		VkDeviceSize reservedSize;	// Size of the range reserved in the block (>= size)
+
 		int refCount = 0;
 	};
 
+	// Device memory block shared by several allocations (or dedicated to a large one)
+	struct MemoryBlock {
+		uint64_t id;
+		VkDeviceMemory memory;
+		VkDevice device;
+		VkDeviceSize size;
+		uint32_t deviceIndex;
+		uint32_t memoryTypeIndex;
+		bool dedicated;
+
+		std::map<VkDeviceSize, VkDeviceSize> freeRanges;	// Offset -> size, coalesced
+		VkDeviceSize usedBytes = 0;
+		uint32_t allocationCount = 0;
+	};
+
+	// Look for an allocation in both the active and cached allocations
+	AllocationInfo* findAllocation(uint64_t allocId);
+
 	VulkanContext* vkContext = nullptr;
 
 	// Map ID -> AllocationInfo
@@ -79,7 +161,11 @@ private:
 	// Store allocations in the order of their last usage
 	std::deque<uint64_t> lruCache;
 
+	// Map ID -> MemoryBlock
+	std::unordered_map<uint64_t, MemoryBlock> memoryBlocks;
+
 	uint64_t nextBufferId = 1;
+	uint64_t nextBlockId = 1;
 
 	// Memory usage
 	std::vector<VkDeviceSize> deviceMemoryBudgets;
@@ -87,5 +173,5 @@ private:
 	std::vector<VkDeviceSize> deviceCachedMemoryUsage;
 
 	// Mutex to protect the memory manager
-	std::recursive_mutex managerMutex;
+	mutable std::recursive_mutex managerMutex;
 };
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "MemoryManager.hpp"
+#include "KernelManager.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+
+// Key formats of the radix sort
+enum class SortKeyType : uint32_t {
+	Uint32 = 0,
+	Uint64 = 1,
+	Float32 = 2,	// Numeric order, -0 before +0, NaNs at the ends according to their sign
+};
+
+
+// Scan, sort and compaction on device buffers of the MemoryManager, without reading the data back to the host
+// Each call records all its passes in a single submission (see KernelManager::dispatchBatch)
+// Buffers may be larger than the element count, the extra elements are left untouched
+class Primitives {
+public:
+	// Prefix sums of uint32 values (input and output may be the same buffer)
+	static void exclusiveScan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count);
+	static void inclusiveScan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count);
+
+	// Stable in-place LSD radix sort, the optional uint32 payloads (null handle to skip them) follow their keys
+	static void radixSort(uint32_t deviceIndex, const MemoryHandle& keys, const MemoryHandle& payloads, uint32_t count,
+						  SortKeyType keyType = SortKeyType::Uint32);
+
+	// Copies the 32-bit elements with a non-zero uint32 flag to the output (sized for count elements), in order
+	// The number of kept elements is written to outputCount[0] (a uint32), so that the result stays on the device
+	static void compact(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& flags, const MemoryHandle& output,
+						const MemoryHandle& outputCount, uint32_t count);
+
+	// Workgroup size of the primitives on a device: a few subgroups, within the device limits
+	static uint32_t getWorkgroupSize(uint32_t deviceIndex);
+
+private:
+	// Append the passes of a scan to a batch (the temporary buffers must outlive the batch)
+	static void appendScan(std::vector<KernelLaunch>& launches, std::vector<MemoryHandle>& scratch, uint32_t deviceIndex,
+						   const MemoryHandle& input, const MemoryHandle& output, uint32_t count, bool inclusive);
+	static void scan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count, bool inclusive);
+};
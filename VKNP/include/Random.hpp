@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+
+// Distributions of the random generator (the values are shared with the compute kernels)
+enum class Distribution : uint32_t {
+	Uniform = 0,	// [a, b)
+	Normal = 1,		// Mean a, standard deviation b (Box-Muller)
+	Bernoulli = 2,	// 1 with probability a, 0 otherwise
+};
+
+
+// Counter-based random stream (Philox4x32-10): element i of a tensor is derived from (seed, offset + i) only,
+// so the values don't depend on the backend, the device or the launch size, and offset continues a stream
+// Uniform and Bernoulli values are bit-identical on every backend, Normal values within the precision of log / sin / cos
+struct RandomSpec {
+	Distribution distribution = Distribution::Uniform;
+	float a = 0.0f;
+	float b = 1.0f;
+	uint64_t seed = 0;
+	uint64_t offset = 0;
+
+	static RandomSpec uniform(float low, float high, uint64_t seed, uint64_t offset = 0);
+	static RandomSpec normal(float mean, float stddev, uint64_t seed, uint64_t offset = 0);
+	static RandomSpec bernoulli(float probability, uint64_t seed, uint64_t offset = 0);
+};
+
+
+// One Philox4x32-10 block: 4 random words per (counter, key)
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+// Values of the elements [first, first + count) of the stream (first is added to the offset of the spec)
+void generateRandom(const RandomSpec& spec, uint64_t first, float* values, size_t count);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Tensor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+
+// How the global tensor is distributed over the devices
+enum class ShardLayout {
+	Split,			// Each device holds a slice along the shard axis
+	Replicated,		// Each device holds the whole tensor
+	Partial,		// Each device holds a partial result of the whole shape, the tensor is their sum (see Dispatcher::allReduce)
+};
+
+
+// Tensor distributed over several devices, one device tensor per shard
+// Shards are views: copies of a ShardedTensor share the device buffers
+class ShardedTensor {
+public:
+	ShardedTensor() = default;
+
+	// Factories (an empty device list uses all the devices of the Vulkan context)
+	// Split: near-equal slices along the axis, at most one per element of the axis
+	static ShardedTensor split(const Tensor& tensor, size_t axis, const std::vector<uint32_t>& deviceIndices = {});
+	static ShardedTensor replicate(const Tensor& tensor, const std::vector<uint32_t>& deviceIndices = {});
+	static ShardedTensor fromShards(std::vector<Tensor> shards, ShardLayout layout, size_t axis = 0);
+
+	// Concatenate the slices, or copy the first replica (partial results must be reduced first)
+	Tensor gather(TensorLocation location = TensorLocation::Host, uint32_t deviceIndex = 0) const;
+
+	// Same layout, devices and shard shapes: elementwise operations can run shard by shard
+	bool isAlignedWith(const ShardedTensor& other) const;
+
+	// Getters
+	const std::vector<size_t>& getShape() const { return shape; }
+	DType getDType() const { return shards.empty() ? DType::Float32 : shards[0].getDType(); }
+	ShardLayout getLayout() const { return layout; }
+	size_t getAxis() const { return axis; }		// Only meaningful for the Split layout
+	size_t getShardCount() const { return shards.size(); }
+	const Tensor& getShard(size_t index) const { return shards.at(index); }
+	const std::vector<Tensor>& getShards() const { return shards; }
+	std::vector<uint32_t> getDeviceIndices() const;
+
+private:
+	std::vector<Tensor> shards;
+	std::vector<size_t> shape;
+	ShardLayout layout = ShardLayout::Replicated;
+	size_t axis = 0;
+};
+
+
+// Run one task per shard, each in its own thread so that the devices work concurrently
+// Waits for all the tasks, then rethrows the first exception
+void runOnShards(size_t shardCount, const std::function<void(size_t)>& task);
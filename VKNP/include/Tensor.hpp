@@ -0,0 +1,69 @@
+#pragma once
+
+#include "MemoryManager.hpp"
+#include "DType.hpp"
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+
+
+// Where the tensor data lives
+enum class TensorLocation {
+	Host,		// Host memory, used by the CPU backend
+	Device,		// Vulkan buffer from the MemoryManager
+};
+
+
+// Contiguous n-dimensional array
+// Copies are views on the same data: device buffers are reference counted by the MemoryManager
+class Tensor {
+public:
+	Tensor() = default;
+	~Tensor();
+
+	Tensor(const Tensor& other);
+	Tensor(Tensor&& other) noexcept;
+	Tensor& operator=(const Tensor& other);
+	Tensor& operator=(Tensor&& other) noexcept;
+
+	// Factories (the content of empty tensors is undefined)
+	static Tensor empty(const std::vector<size_t>& shape, TensorLocation location = TensorLocation::Host,
+						uint32_t deviceIndex = 0, DType dtype = DType::Float32);
+	static Tensor fromVector(const std::vector<float>& values, const std::vector<size_t>& shape,
+							 TensorLocation location = TensorLocation::Host, uint32_t deviceIndex = 0, DType dtype = DType::Float32);
+
+	// Transfers (returns a view if the tensor is already at the requested location)
+	Tensor to(TensorLocation location, uint32_t deviceIndex = 0) const;
+	std::vector<float> toVector() const;	// Converted to float32
+
+	// Getters
+	const std::vector<size_t>& getShape() const { return shape; }
+	size_t getElementCount() const;
+	size_t getByteSize() const { return getElementCount() * getDTypeSize(dtype); }
+	DType getDType() const { return dtype; }
+	TensorLocation getLocation() const { return location; }
+	bool isHost() const { return location == TensorLocation::Host; }
+	uint32_t getDeviceIndex() const { return deviceIndex; }
+	const MemoryHandle& getHandle() const { return handle; }
+
+	// Host data access (only valid for host tensors)
+	void* getHostData();
+	const void* getHostData() const;
+
+private:
+	void release();
+
+private:
+	std::vector<size_t> shape;
+	DType dtype = DType::Float32;
+	TensorLocation location = TensorLocation::Host;
+	uint32_t deviceIndex = 0;
+
+	// Storage: only one of them is used depending on the location
+	MemoryHandle handle;
+	std::shared_ptr<std::vector<std::byte>> hostStorage;
+};
@@ -1 +1,14 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+#include "VulkanContext.hpp"
+#include "MemoryManager.hpp"
+#include "KernelManager.hpp"
+#include "EmbeddedKernels.hpp"
+#include "Primitives.hpp"
+#include "Tensor.hpp"
+#include "Broadcast.hpp"
+#include "ShardedTensor.hpp"
+#include "Backend.hpp"
+#include "CpuBackend.hpp"
+#include "VulkanBackend.hpp"
+#include "Dispatcher.hpp"
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Backend.hpp"
+
+
+
+// Backend running the compute kernels through the KernelManager
+class VulkanBackend : public Backend {
+public:
+	BackendType getType() const override { return BackendType::Vulkan; }
+
+	void binary(BinaryOp op, const Tensor& a, const Tensor& b, Tensor& out) override;
+	void unary(UnaryOp op, const Tensor& a, Tensor& out, float alpha = 1.0f) override;
+	void matmul(const Tensor& a, const Tensor& b, Tensor& out) override;
+	void convert(const Tensor& a, Tensor& out) override;
+	void random(const RandomSpec& spec, Tensor& out) override;
+	void randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha, Tensor& out) override;
+};
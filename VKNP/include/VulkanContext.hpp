@@ -2,16 +2,46 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <iostream>
 #include <string>
 
 
+// Optional features probed and enabled on each device
+struct DeviceFeatures {
+	bool storageBuffer16BitAccess = false;	// 16-bit loads and stores in storage buffers (fp16 / bf16 tensors)
+	bool shaderFloat16 = false;				// 16-bit float arithmetic in shaders
+};
+
+
+// Compute limits of each device, used to size the workgroups
+struct DeviceLimits {
+	uint32_t subgroupSize = 1;
+	uint32_t maxWorkgroupSize = 128;			// Minimum of maxComputeWorkGroupSize[0] and maxComputeWorkGroupInvocations
+	uint32_t maxSharedMemorySize = 16384;		// Bytes of shared memory per workgroup
+};
+
+
+// Command buffer submitted on a device queue, to be waited on with VulkanContext::wait
+struct Submission {
+	uint32_t deviceIndex = 0;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+};
+
+
 class VulkanContext {
 public:
 	// Singleton access
 	static VulkanContext& getContext();
 
+	// Create several logical devices (each with its own queue) over every physical device
+	// Must be called before the first getContext call, mainly used to test multi-device code on a single GPU
+	static void setLogicalDevicesPerPhysicalDevice(uint32_t count);
+
     // Getters
 	VkInstance getInstance() const { return instance; }
 	uint32_t getDeviceCount() const { return deviceCount; }
@@ -20,11 +50,23 @@ public:
     const std::vector<VkDevice>& getDevices() const { return devices; }
     const std::vector<VkQueue>& getQueues() const { return queues; }
     const std::vector<VkCommandPool>& getCommandPools() const { return commandPools; }
+	const std::vector<DeviceFeatures>& getDeviceFeatures() const { return deviceFeatures; }
+	const std::vector<DeviceLimits>& getDeviceLimits() const { return deviceLimits; }
 
 	// Memory management
-    void createBufferAndMemory(VkDevice device, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) const;
+    void createBufferAndMemory(VkDevice device, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory,
+							   VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) const;
+	VkBuffer createBuffer(VkDevice device, VkDeviceSize size) const;
+	uint32_t findMemoryType(uint32_t deviceIndex, uint32_t typeBits, VkMemoryPropertyFlags properties) const;
 	std::pair<VkDeviceSize, VkDeviceSize> getMemoryUsage(VkPhysicalDevice device) const;
 
+	// Record a one-time command buffer, submit it on the device queue and wait for its completion
+	void submitAndWait(uint32_t deviceIndex, const std::function<void(VkCommandBuffer)>& record);
+
+	// Same in two steps: the queue is only locked during the submission, so other threads can submit while waiting
+	Submission submit(uint32_t deviceIndex, const std::function<void(VkCommandBuffer)>& record);
+	void wait(Submission& submission);
+
 private:
 	// Singleton: private constructor and destructor
 	VulkanContext();
@@ -39,6 +81,7 @@ private:
     void pickPhysicalDevices();
     void createDevicesAndQueues();
     void createCommandPools();
+	bool isDeviceExtensionSupported(VkPhysicalDevice device, const char* extension) const;
 
 private:
 	// Extension lists
@@ -47,6 +90,12 @@ private:
 		VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME,
 		VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
 	};
+	// Enabled only when the device supports them
+	const std::vector<const char*> optionalDeviceExtensions = {
+		VK_KHR_16BIT_STORAGE_EXTENSION_NAME,
+		VK_KHR_STORAGE_BUFFER_STORAGE_CLASS_EXTENSION_NAME,	// Required by VK_KHR_16bit_storage
+		VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME,
+	};
 
     VkInstance instance = VK_NULL_HANDLE;
 
@@ -55,6 +104,15 @@ private:
     std::vector<VkDevice> devices;
     std::vector<VkQueue> queues;
     std::vector<VkCommandPool> commandPools;
+	std::vector<DeviceFeatures> deviceFeatures;
+	std::vector<DeviceLimits> deviceLimits;
+
+	// Queues and command pools must be externally synchronized
+	std::vector<std::unique_ptr<std::mutex>> queueMutexes;
 
 	uint32_t deviceCount = 0;
+
+	// Configuration applied when the singleton is created
+	static uint32_t s_logicalDevicesPerPhysicalDevice;
+	static bool s_created;
 };
\ No newline at end of file
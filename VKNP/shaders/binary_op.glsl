@@ -0,0 +1,21 @@
+// Binary op codes of the BinaryOp enum, for scalars and vec4
+
+float applyBinaryOp(uint op, float x, float y) {
+	switch (op) {
+		case 0u: return x + y;
+		case 1u: return x - y;
+		case 2u: return x * y;
+		case 3u: return x / y;
+	}
+	return 0.0;
+}
+
+vec4 applyBinaryOp(uint op, vec4 x, vec4 y) {
+	switch (op) {
+		case 0u: return x + y;
+		case 1u: return x - y;
+		case 2u: return x * y;
+		case 3u: return x / y;
+	}
+	return vec4(0.0);
+}
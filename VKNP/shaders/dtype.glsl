@@ -0,0 +1,35 @@
+// Storage type and float32 conversions of the tensor elements
+// Must be included right after #version, kernels are compiled with:
+//   DTYPE=<value of the DType enum> (0: float32, 1: float16, 2: bfloat16)
+//   USE_16BIT_STORAGE when a 16-bit dtype is involved (requires storageBuffer16BitAccess)
+
+#ifdef USE_16BIT_STORAGE
+#extension GL_EXT_shader_16bit_storage : require
+
+float bfloat16ToFloat(uint16_t value) {
+	return uintBitsToFloat(uint(value) << 16);
+}
+
+// Round to nearest even, NaNs stay quiet
+uint16_t floatToBFloat16(float value) {
+	uint bits = floatBitsToUint(value);
+	if (isnan(value)) {
+		return uint16_t((bits >> 16) | 0x40u);
+	}
+	return uint16_t((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+}
+#endif
+
+#if defined(DTYPE) && DTYPE == 1
+#define ELEMENT_TYPE float16_t
+#define TO_FLOAT(x) float(x)
+#define FROM_FLOAT(x) float16_t(x)
+#elif defined(DTYPE) && DTYPE == 2
+#define ELEMENT_TYPE uint16_t
+#define TO_FLOAT(x) bfloat16ToFloat(x)
+#define FROM_FLOAT(x) floatToBFloat16(x)
+#else
+#define ELEMENT_TYPE float
+#define TO_FLOAT(x) (x)
+#define FROM_FLOAT(x) (x)
+#endif
@@ -0,0 +1,48 @@
+// Counter-based random numbers: Philox4x32-10 and the distributions of the Distribution enum
+// Must match src/Random.cpp, so that every backend produces the same streams
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+#define UNIT_SCALE (1.0 / 16777216.0)
+#define TWO_PI 6.28318530717958647692
+
+uvec4 philox4x32(uvec4 counter, uvec2 key) {
+	for (int i = 0; i < 10; i++) {
+		uint hi0, lo0, hi1, lo1;
+		umulExtended(PHILOX_M0, counter.x, hi0, lo0);
+		umulExtended(PHILOX_M1, counter.z, hi1, lo1);
+
+		counter = uvec4(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+		key += uvec2(PHILOX_W0, PHILOX_W1);
+	}
+	return counter;
+}
+
+// The 4 values of a block, the Box-Muller pairs are (x, y) and (z, w)
+// precise: no fused multiply-add, the results must match the CPU bit for bit
+vec4 toDistribution(uvec4 bits, uint distribution, float a, float b) {
+	precise vec4 unit = vec4(bits >> 8u) * UNIT_SCALE;
+	precise vec4 values = vec4(0.0);
+
+	switch (distribution) {
+		case 0u:		// Uniform
+			values = a + (b - a) * unit;
+			break;
+
+		case 1u: {	// Normal
+			vec2 u1 = vec2((bits.xz >> 8u) + 1u) * UNIT_SCALE;
+			vec2 radius = sqrt(-2.0 * log(u1));
+			vec2 angle = TWO_PI * unit.yw;
+			values = a + b * vec4(radius.x * cos(angle.x), radius.x * sin(angle.x), radius.y * cos(angle.y), radius.y * sin(angle.y));
+			break;
+		}
+
+		case 2u:		// Bernoulli
+			values = vec4(lessThan(unit, vec4(a)));
+			break;
+	}
+	return values;
+}
@@ -0,0 +1,32 @@
+// Workgroup building blocks of the scan, sort and compaction kernels
+// The workgroup size is a specialization constant chosen from the subgroup size of the device (see Primitives)
+// Each workgroup processes tiles of TILE_SIZE elements, in a blocked arrangement (consecutive elements per invocation)
+
+#define ITEMS_PER_INVOCATION 4
+
+layout(constant_id = 0) const uint WORKGROUP_SIZE = 256;
+layout(constant_id = 1) const uint TILE_SIZE = 1024;	// WORKGROUP_SIZE * ITEMS_PER_INVOCATION
+
+layout(local_size_x_id = 0) in;
+
+shared uint scanSums[WORKGROUP_SIZE];
+
+// Exclusive prefix sum of one value per invocation, the sum of all the values is returned in total
+// Must be reached by the whole workgroup (contains barriers)
+uint workgroupExclusiveScan(uint value, out uint total) {
+	uint lid = gl_LocalInvocationID.x;
+	scanSums[lid] = value;
+	barrier();
+
+	for (uint offset = 1u; offset < WORKGROUP_SIZE; offset <<= 1) {
+		uint addend = lid >= offset ? scanSums[lid - offset] : 0u;
+		barrier();
+		scanSums[lid] += addend;
+		barrier();
+	}
+
+	total = scanSums[WORKGROUP_SIZE - 1u];
+	uint result = scanSums[lid] - value;
+	barrier();	// scanSums can be reused by the next call
+	return result;
+}
@@ -0,0 +1,91 @@
+#include "Broadcast.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+
+
+
+static std::string shapeToString(const std::vector<size_t>& shape) {
+	std::string text = "[";
+	for (size_t i = 0; i < shape.size(); i++) {
+		text += (i > 0 ? ", " : "") + std::to_string(shape[i]);
+	}
+	return text + "]";
+}
+
+
+std::vector<size_t> broadcastShapes(const std::vector<size_t>& a, const std::vector<size_t>& b) {
+	// Right-aligned, missing leading dimensions count as 1
+	size_t rank = std::max(a.size(), b.size());
+	std::vector<size_t> shape(rank);
+	for (size_t i = 0; i < rank; i++) {
+		size_t da = i < rank - a.size() ? 1 : a[i - (rank - a.size())];
+		size_t db = i < rank - b.size() ? 1 : b[i - (rank - b.size())];
+		if (da != db && da != 1 && db != 1) {
+			throw std::runtime_error("Unable to broadcast shapes " + shapeToString(a) + " and " + shapeToString(b));
+		}
+		shape[i] = da == 1 ? db : da;
+	}
+	return shape;
+}
+
+
+// Strides of a contiguous operand aligned on the output dimensions, zero where it is broadcast
+static std::vector<size_t> getAlignedStrides(const std::vector<size_t>& shape, const std::vector<size_t>& outShape) {
+	size_t rank = outShape.size();
+	std::vector<size_t> strides(rank, 0);
+	size_t stride = 1;
+	for (size_t i = 0; i < shape.size(); i++) {
+		size_t dim = shape.size() - 1 - i;
+		size_t outDim = rank - 1 - i;
+		if (shape[dim] != 1) {
+			strides[outDim] = stride;
+		}
+		stride *= shape[dim];
+	}
+	return strides;
+}
+
+
+BroadcastLayout BroadcastLayout::create(const std::vector<size_t>& shapeA, const std::vector<size_t>& shapeB,
+										const std::vector<size_t>& outShape) {
+	if (shapeA.size() > outShape.size() || shapeB.size() > outShape.size() || broadcastShapes(shapeA, outShape) != outShape ||
+		broadcastShapes(shapeB, outShape) != outShape) {
+		throw std::runtime_error("Operands of shapes " + shapeToString(shapeA) + " and " + shapeToString(shapeB) +
+								 " don't broadcast to " + shapeToString(outShape));
+	}
+	std::vector<size_t> stridesA = getAlignedStrides(shapeA, outShape);
+	std::vector<size_t> stridesB = getAlignedStrides(shapeB, outShape);
+
+	// Empty outputs are trivially contiguous, single elements are an inner dimension of size 1
+	BroadcastLayout layout;
+	size_t count = 1;
+	for (size_t dim : outShape) {
+		count *= dim;
+	}
+	if (count <= 1) {
+		layout.shape = { count };
+		layout.stridesA = { 1 };
+		layout.stridesB = { 1 };
+		return layout;
+	}
+
+	// Drop the dimensions of size 1, then merge each dimension into the previous one when both operands are contiguous across them
+	for (size_t i = 0; i < outShape.size(); i++) {
+		if (outShape[i] == 1) {
+			continue;
+		}
+		if (!layout.shape.empty() &&
+			layout.stridesA.back() == stridesA[i] * outShape[i] && layout.stridesB.back() == stridesB[i] * outShape[i]) {
+			layout.shape.back() *= outShape[i];
+			layout.stridesA.back() = stridesA[i];
+			layout.stridesB.back() = stridesB[i];
+			continue;
+		}
+		layout.shape.push_back(outShape[i]);
+		layout.stridesA.push_back(stridesA[i]);
+		layout.stridesB.push_back(stridesB[i]);
+	}
+	return layout;
+}
@@ -0,0 +1,566 @@
+#include "CpuBackend.hpp"
+#include "Broadcast.hpp"
+
+#include <stdexcept>
+#include <exception>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VKNP_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define VKNP_NEON 1
+#endif
+
+#define ELEMENTWISE_GRAIN_SIZE (1 << 15)	// Minimum number of elements per thread
+#define MATMUL_GRAIN_FLOPS (1 << 18)		// Minimum number of multiply-adds per thread
+#define MATMUL_BLOCK_K 256					// Rows of B kept in cache while processing a block of rows of A
+#define CONVERSION_TILE_SIZE 1024			// Elements converted to float32 at once for 16-bit dtypes
+
+
+// #################################################################################################
+// ###   CPU kernels: Scalar
+// #################################################################################################
+
+
+static void binaryScalar(BinaryOp op, const float* a, const float* b, float* c, size_t n) {
+	switch (op) {
+		case BinaryOp::Add: for (size_t i = 0; i < n; i++) c[i] = a[i] + b[i]; break;
+		case BinaryOp::Sub: for (size_t i = 0; i < n; i++) c[i] = a[i] - b[i]; break;
+		case BinaryOp::Mul: for (size_t i = 0; i < n; i++) c[i] = a[i] * b[i]; break;
+		case BinaryOp::Div: for (size_t i = 0; i < n; i++) c[i] = a[i] / b[i]; break;
+	}
+}
+
+
+static void unaryScalar(UnaryOp op, const float* a, float* b, size_t n, float alpha) {
+	switch (op) {
+		case UnaryOp::Relu:  for (size_t i = 0; i < n; i++) b[i] = std::max(a[i], 0.0f); break;
+		case UnaryOp::Neg:   for (size_t i = 0; i < n; i++) b[i] = -a[i]; break;
+		case UnaryOp::Exp:   for (size_t i = 0; i < n; i++) b[i] = std::exp(a[i]); break;
+		case UnaryOp::Scale: for (size_t i = 0; i < n; i++) b[i] = a[i] * alpha; break;
+	}
+}
+
+
+// y += alpha * x
+static void axpyScalar(float alpha, const float* x, float* y, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		y[i] += alpha * x[i];
+	}
+}
+
+
+// #################################################################################################
+// ###   CPU kernels: AVX2 / AVX-512
+// #################################################################################################
+
+
+#ifdef VKNP_X86
+
+__attribute__((target("avx2,fma")))
+static void binaryAvx2(BinaryOp op, const float* a, const float* b, float* c, size_t n) {
+	size_t i = 0;
+	switch (op) {
+		case BinaryOp::Add: for (; i + 8 <= n; i += 8) _mm256_storeu_ps(c + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))); break;
+		case BinaryOp::Sub: for (; i + 8 <= n; i += 8) _mm256_storeu_ps(c + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))); break;
+		case BinaryOp::Mul: for (; i + 8 <= n; i += 8) _mm256_storeu_ps(c + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))); break;
+		case BinaryOp::Div: for (; i + 8 <= n; i += 8) _mm256_storeu_ps(c + i, _mm256_div_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))); break;
+	}
+	binaryScalar(op, a + i, b + i, c + i, n - i);
+}
+
+
+__attribute__((target("avx2,fma")))
+static void unaryAvx2(UnaryOp op, const float* a, float* b, size_t n, float alpha) {
+	size_t i = 0;
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 scale = _mm256_set1_ps(alpha);
+	switch (op) {
+		case UnaryOp::Relu:  for (; i + 8 <= n; i += 8) _mm256_storeu_ps(b + i, _mm256_max_ps(_mm256_loadu_ps(a + i), zero)); break;
+		case UnaryOp::Neg:   for (; i + 8 <= n; i += 8) _mm256_storeu_ps(b + i, _mm256_sub_ps(zero, _mm256_loadu_ps(a + i))); break;
+		case UnaryOp::Scale: for (; i + 8 <= n; i += 8) _mm256_storeu_ps(b + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), scale)); break;
+		case UnaryOp::Exp:   break;	// No vector exp in the intrinsics, left to the scalar loop
+	}
+	unaryScalar(op, a + i, b + i, n - i, alpha);
+}
+
+
+__attribute__((target("avx2,fma")))
+static void axpyAvx2(float alpha, const float* x, float* y, size_t n) {
+	size_t i = 0;
+	const __m256 a = _mm256_set1_ps(alpha);
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(y + i, _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+	}
+	axpyScalar(alpha, x + i, y + i, n - i);
+}
+
+
+__attribute__((target("avx512f")))
+static void binaryAvx512(BinaryOp op, const float* a, const float* b, float* c, size_t n) {
+	size_t i = 0;
+	switch (op) {
+		case BinaryOp::Add: for (; i + 16 <= n; i += 16) _mm512_storeu_ps(c + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))); break;
+		case BinaryOp::Sub: for (; i + 16 <= n; i += 16) _mm512_storeu_ps(c + i, _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))); break;
+		case BinaryOp::Mul: for (; i + 16 <= n; i += 16) _mm512_storeu_ps(c + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))); break;
+		case BinaryOp::Div: for (; i + 16 <= n; i += 16) _mm512_storeu_ps(c + i, _mm512_div_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))); break;
+	}
+	binaryScalar(op, a + i, b + i, c + i, n - i);
+}
+
+
+__attribute__((target("avx512f")))
+static void unaryAvx512(UnaryOp op, const float* a, float* b, size_t n, float alpha) {
+	size_t i = 0;
+	const __m512 zero = _mm512_setzero_ps();
+	const __m512 scale = _mm512_set1_ps(alpha);
+	switch (op) {
+		case UnaryOp::Relu:  for (; i + 16 <= n; i += 16) _mm512_storeu_ps(b + i, _mm512_maskz_max_ps(0xFFFF, _mm512_loadu_ps(a + i), zero)); break;
+		case UnaryOp::Neg:   for (; i + 16 <= n; i += 16) _mm512_storeu_ps(b + i, _mm512_sub_ps(zero, _mm512_loadu_ps(a + i))); break;
+		case UnaryOp::Scale: for (; i + 16 <= n; i += 16) _mm512_storeu_ps(b + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), scale)); break;
+		case UnaryOp::Exp:   break;
+	}
+	unaryScalar(op, a + i, b + i, n - i, alpha);
+}
+
+
+__attribute__((target("avx512f")))
+static void axpyAvx512(float alpha, const float* x, float* y, size_t n) {
+	size_t i = 0;
+	const __m512 a = _mm512_set1_ps(alpha);
+	for (; i + 16 <= n; i += 16) {
+		_mm512_storeu_ps(y + i, _mm512_fmadd_ps(a, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+	}
+	axpyScalar(alpha, x + i, y + i, n - i);
+}
+
+#endif
+
+
+// #################################################################################################
+// ###   CPU kernels: NEON
+// #################################################################################################
+
+
+#ifdef VKNP_NEON
+
+static void binaryNeon(BinaryOp op, const float* a, const float* b, float* c, size_t n) {
+	size_t i = 0;
+	switch (op) {
+		case BinaryOp::Add: for (; i + 4 <= n; i += 4) vst1q_f32(c + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i))); break;
+		case BinaryOp::Sub: for (; i + 4 <= n; i += 4) vst1q_f32(c + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i))); break;
+		case BinaryOp::Mul: for (; i + 4 <= n; i += 4) vst1q_f32(c + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i))); break;
+		case BinaryOp::Div: for (; i + 4 <= n; i += 4) vst1q_f32(c + i, vdivq_f32(vld1q_f32(a + i), vld1q_f32(b + i))); break;
+	}
+	binaryScalar(op, a + i, b + i, c + i, n - i);
+}
+
+
+static void unaryNeon(UnaryOp op, const float* a, float* b, size_t n, float alpha) {
+	size_t i = 0;
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	switch (op) {
+		case UnaryOp::Relu:  for (; i + 4 <= n; i += 4) vst1q_f32(b + i, vmaxq_f32(vld1q_f32(a + i), zero)); break;
+		case UnaryOp::Neg:   for (; i + 4 <= n; i += 4) vst1q_f32(b + i, vnegq_f32(vld1q_f32(a + i))); break;
+		case UnaryOp::Scale: for (; i + 4 <= n; i += 4) vst1q_f32(b + i, vmulq_n_f32(vld1q_f32(a + i), alpha)); break;
+		case UnaryOp::Exp:   break;
+	}
+	unaryScalar(op, a + i, b + i, n - i, alpha);
+}
+
+
+static void axpyNeon(float alpha, const float* x, float* y, size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), alpha));
+	}
+	axpyScalar(alpha, x + i, y + i, n - i);
+}
+
+#endif
+
+
+// #################################################################################################
+// ###   CPU kernels: Runtime dispatch
+// #################################################################################################
+
+
+struct CpuKernels {
+	void (*binary)(BinaryOp, const float*, const float*, float*, size_t);
+	void (*unary)(UnaryOp, const float*, float*, size_t, float);
+	void (*axpy)(float, const float*, float*, size_t);
+};
+
+
+static CpuKernels getKernels(SimdLevel level) {
+	switch (level) {
+#ifdef VKNP_X86
+		case SimdLevel::Avx512: return { binaryAvx512, unaryAvx512, axpyAvx512 };
+		case SimdLevel::Avx2:   return { binaryAvx2, unaryAvx2, axpyAvx2 };
+#endif
+#ifdef VKNP_NEON
+		case SimdLevel::Neon:   return { binaryNeon, unaryNeon, axpyNeon };
+#endif
+		default:                return { binaryScalar, unaryScalar, axpyScalar };
+	}
+}
+
+
+const char* getSimdLevelName(SimdLevel level) {
+	switch (level) {
+		case SimdLevel::Scalar: return "scalar";
+		case SimdLevel::Neon:   return "neon";
+		case SimdLevel::Avx2:   return "avx2";
+		case SimdLevel::Avx512: return "avx512";
+	}
+	return "unknown";
+}
+
+
+SimdLevel CpuBackend::detectSimdLevel() {
+#ifdef VKNP_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return SimdLevel::Avx512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return SimdLevel::Avx2;
+	}
+	return SimdLevel::Scalar;
+#elif defined(VKNP_NEON)
+	return SimdLevel::Neon;	// Mandatory on AArch64
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+
+// #################################################################################################
+// ###   CpuBackend: Thread pool
+// #################################################################################################
+
+
+CpuBackend::CpuBackend(uint32_t threadCount) : simdLevel(detectSimdLevel()) {
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	// The calling thread also takes a share of the work
+	for (uint32_t i = 1; i < threadCount; i++) {
+		workers.emplace_back(&CpuBackend::workerLoop, this);
+	}
+}
+
+
+CpuBackend::~CpuBackend() {
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		stopping = true;
+	}
+	taskCondition.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+
+bool CpuBackend::isSimdLevelSupported(SimdLevel level) {
+	SimdLevel detected = detectSimdLevel();
+	switch (level) {
+		case SimdLevel::Scalar: return true;
+		case SimdLevel::Neon:   return detected == SimdLevel::Neon;
+		case SimdLevel::Avx2:   return detected == SimdLevel::Avx2 || detected == SimdLevel::Avx512;
+		case SimdLevel::Avx512: return detected == SimdLevel::Avx512;
+	}
+	return false;
+}
+
+
+void CpuBackend::setSimdLevel(SimdLevel level) {
+	if (!isSimdLevelSupported(level)) {
+		throw std::runtime_error(std::string("SIMD level ") + getSimdLevelName(level) + " not supported by this CPU");
+	}
+	simdLevel = level;
+}
+
+
+void CpuBackend::workerLoop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(taskMutex);
+			taskCondition.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty()) {
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+
+void CpuBackend::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& task) {
+	size_t chunkCount = std::min<size_t>(getThreadCount(), (count + grainSize - 1) / std::max<size_t>(grainSize, 1));
+	if (chunkCount <= 1) {
+		task(0, count);
+		return;
+	}
+
+	size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+	size_t remaining = chunkCount - 1;	// Guarded by doneMutex
+	std::exception_ptr error;			// First exception of a chunk, guarded by doneMutex
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+
+	// Exceptions are kept until all the chunks are done: the queued ones reference the locals of this frame
+	auto runChunk = [&](size_t begin, size_t end) {
+		try {
+			task(begin, end);
+		} catch (...) {
+			std::lock_guard<std::mutex> doneLock(doneMutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	// Queue all the chunks but the first one, which is run by the calling thread
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		for (size_t c = 1; c < chunkCount; c++) {
+			size_t begin = c * chunkSize;
+			size_t end = std::min(count, begin + chunkSize);
+			tasks.emplace_back([&, begin, end] {
+				runChunk(begin, end);
+				std::lock_guard<std::mutex> doneLock(doneMutex);
+				if (--remaining == 0) {
+					doneCondition.notify_one();
+				}
+			});
+		}
+	}
+	taskCondition.notify_all();
+
+	runChunk(0, std::min(count, chunkSize));
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneCondition.wait(lock, [&] { return remaining == 0; });
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+
+// #################################################################################################
+// ###   CpuBackend: Operations
+// #################################################################################################
+
+
+// n consecutive values of an operand as float32: in place for float32, converted or splatted into the tile otherwise
+static const float* loadOperandRow(DType dtype, const std::byte* data, size_t offset, bool broadcast, size_t n, float* tile) {
+	size_t elementSize = getDTypeSize(dtype);
+	if (broadcast) {
+		float value;
+		convertToFloat(dtype, data + offset * elementSize, &value, 1);
+		std::fill_n(tile, n, value);
+		return tile;
+	}
+	if (dtype == DType::Float32) {
+		return reinterpret_cast<const float*>(data) + offset;
+	}
+	convertToFloat(dtype, data + offset * elementSize, tile, n);
+	return tile;
+}
+
+
+// 16-bit tensors are converted to float32 by tiles small enough to stay in the L1 cache
+void CpuBackend::binary(BinaryOp op, const Tensor& a, const Tensor& b, Tensor& out) {
+	const std::byte* pa = static_cast<const std::byte*>(a.getHostData());
+	const std::byte* pb = static_cast<const std::byte*>(b.getHostData());
+	std::byte* pc = static_cast<std::byte*>(out.getHostData());
+	DType dtype = out.getDType();
+	size_t elementSize = getDTypeSize(dtype);
+	CpuKernels kernels = getKernels(simdLevel);
+
+	// Broadcasting: the output is processed by rows of its innermost dimension, along which the operands
+	// are either contiguous or a single value
+	BroadcastLayout layout = BroadcastLayout::create(a.getShape(), b.getShape(), out.getShape());
+	if (!layout.isContiguous()) {
+		size_t inner = layout.getRank() - 1;
+		size_t rowLength = layout.getInnerSize();
+		size_t rowCount = out.getElementCount() / rowLength;
+
+		parallelFor(rowCount, std::max<size_t>(ELEMENTWISE_GRAIN_SIZE / rowLength, 1), [&](size_t begin, size_t end) {
+			float tileA[CONVERSION_TILE_SIZE], tileB[CONVERSION_TILE_SIZE], tileC[CONVERSION_TILE_SIZE];
+			for (size_t row = begin; row < end; row++) {
+				size_t offsetA = 0;
+				size_t offsetB = 0;
+				size_t remaining = row;
+				for (size_t d = inner; d > 0; d--) {
+					size_t coordinate = remaining % layout.shape[d - 1];
+					remaining /= layout.shape[d - 1];
+					offsetA += coordinate * layout.stridesA[d - 1];
+					offsetB += coordinate * layout.stridesB[d - 1];
+				}
+
+				for (size_t i = 0; i < rowLength; i += CONVERSION_TILE_SIZE) {
+					size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, rowLength - i);
+					size_t outOffset = row * rowLength + i;
+					const float* x = loadOperandRow(dtype, pa, offsetA + i * layout.stridesA[inner], layout.stridesA[inner] == 0, n, tileA);
+					const float* y = loadOperandRow(dtype, pb, offsetB + i * layout.stridesB[inner], layout.stridesB[inner] == 0, n, tileB);
+					if (dtype == DType::Float32) {
+						kernels.binary(op, x, y, reinterpret_cast<float*>(pc) + outOffset, n);
+					} else {
+						kernels.binary(op, x, y, tileC, n);
+						convertFromFloat(dtype, tileC, pc + outOffset * elementSize, n);
+					}
+				}
+			}
+		});
+		return;
+	}
+
+	parallelFor(out.getElementCount(), ELEMENTWISE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+		if (dtype == DType::Float32) {
+			kernels.binary(op, reinterpret_cast<const float*>(pa) + begin, reinterpret_cast<const float*>(pb) + begin,
+						   reinterpret_cast<float*>(pc) + begin, end - begin);
+			return;
+		}
+
+		float tileA[CONVERSION_TILE_SIZE], tileB[CONVERSION_TILE_SIZE], tileC[CONVERSION_TILE_SIZE];
+		for (size_t i = begin; i < end; i += CONVERSION_TILE_SIZE) {
+			size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, end - i);
+			convertToFloat(dtype, pa + i * elementSize, tileA, n);
+			convertToFloat(dtype, pb + i * elementSize, tileB, n);
+			kernels.binary(op, tileA, tileB, tileC, n);
+			convertFromFloat(dtype, tileC, pc + i * elementSize, n);
+		}
+	});
+}
+
+
+void CpuBackend::unary(UnaryOp op, const Tensor& a, Tensor& out, float alpha) {
+	const std::byte* pa = static_cast<const std::byte*>(a.getHostData());
+	std::byte* pb = static_cast<std::byte*>(out.getHostData());
+	DType dtype = out.getDType();
+	size_t elementSize = getDTypeSize(dtype);
+	CpuKernels kernels = getKernels(simdLevel);
+
+	parallelFor(out.getElementCount(), ELEMENTWISE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+		if (dtype == DType::Float32) {
+			kernels.unary(op, reinterpret_cast<const float*>(pa) + begin, reinterpret_cast<float*>(pb) + begin, end - begin, alpha);
+			return;
+		}
+
+		float tileA[CONVERSION_TILE_SIZE], tileB[CONVERSION_TILE_SIZE];
+		for (size_t i = begin; i < end; i += CONVERSION_TILE_SIZE) {
+			size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, end - i);
+			convertToFloat(dtype, pa + i * elementSize, tileA, n);
+			kernels.unary(op, tileA, tileB, n, alpha);
+			convertFromFloat(dtype, tileB, pb + i * elementSize, n);
+		}
+	});
+}
+
+
+// Row-parallel GEMM: each row of C accumulates rows of B scaled by the elements of A (vectorized axpy)
+// 16-bit inputs are widened to float32 once, the accumulation is always done in float32
+void CpuBackend::matmul(const Tensor& a, const Tensor& b, Tensor& out) {
+	size_t M = a.getShape()[0];
+	size_t K = a.getShape()[1];
+	size_t N = b.getShape()[1];
+	DType dtype = out.getDType();
+
+	std::vector<float> wideA, wideB, wideC;
+	const float* pa = static_cast<const float*>(a.getHostData());
+	const float* pb = static_cast<const float*>(b.getHostData());
+	float* pc = static_cast<float*>(out.getHostData());
+	if (dtype != DType::Float32) {
+		wideA.resize(M * K);
+		wideB.resize(K * N);
+		wideC.resize(M * N);
+		convertToFloat(dtype, a.getHostData(), wideA.data(), wideA.size());
+		convertToFloat(dtype, b.getHostData(), wideB.data(), wideB.size());
+		pa = wideA.data();
+		pb = wideB.data();
+		pc = wideC.data();
+	}
+	CpuKernels kernels = getKernels(simdLevel);
+
+	size_t rowGrain = std::max<size_t>(1, MATMUL_GRAIN_FLOPS / std::max<size_t>(N * K, 1));
+	parallelFor(M, rowGrain, [&](size_t begin, size_t end) {
+		std::fill(pc + begin * N, pc + end * N, 0.0f);
+		for (size_t kBlock = 0; kBlock < K; kBlock += MATMUL_BLOCK_K) {
+			size_t kEnd = std::min(K, kBlock + MATMUL_BLOCK_K);
+			for (size_t i = begin; i < end; i++) {
+				for (size_t k = kBlock; k < kEnd; k++) {
+					kernels.axpy(pa[i * K + k], pb + k * N, pc + i * N, N);
+				}
+			}
+		}
+	});
+
+	if (dtype != DType::Float32) {
+		convertFromFloat(dtype, wideC.data(), out.getHostData(), wideC.size());
+	}
+}
+
+
+void CpuBackend::convert(const Tensor& a, Tensor& out) {
+	const std::byte* pa = static_cast<const std::byte*>(a.getHostData());
+	std::byte* pb = static_cast<std::byte*>(out.getHostData());
+	DType srcType = a.getDType();
+	DType dstType = out.getDType();
+
+	parallelFor(out.getElementCount(), ELEMENTWISE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+		float tile[CONVERSION_TILE_SIZE];
+		for (size_t i = begin; i < end; i += CONVERSION_TILE_SIZE) {
+			size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, end - i);
+			convertToFloat(srcType, pa + i * getDTypeSize(srcType), tile, n);
+			convertFromFloat(dstType, tile, pb + i * getDTypeSize(dstType), n);
+		}
+	});
+}
+
+
+// Same streams as the random kernels: each tile continues the stream at its own element index
+void CpuBackend::random(const RandomSpec& spec, Tensor& out) {
+	std::byte* pb = static_cast<std::byte*>(out.getHostData());
+	DType dtype = out.getDType();
+	size_t elementSize = getDTypeSize(dtype);
+
+	parallelFor(out.getElementCount(), ELEMENTWISE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+		float tile[CONVERSION_TILE_SIZE];
+		for (size_t i = begin; i < end; i += CONVERSION_TILE_SIZE) {
+			size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, end - i);
+			generateRandom(spec, i, tile, n);
+			convertFromFloat(dtype, tile, pb + i * elementSize, n);
+		}
+	});
+}
+
+
+void CpuBackend::randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha, Tensor& out) {
+	const std::byte* pa = static_cast<const std::byte*>(a.getHostData());
+	std::byte* pc = static_cast<std::byte*>(out.getHostData());
+	DType dtype = out.getDType();
+	size_t elementSize = getDTypeSize(dtype);
+	CpuKernels kernels = getKernels(simdLevel);
+
+	parallelFor(out.getElementCount(), ELEMENTWISE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+		float tileA[CONVERSION_TILE_SIZE], tileR[CONVERSION_TILE_SIZE], tileC[CONVERSION_TILE_SIZE];
+		for (size_t i = begin; i < end; i += CONVERSION_TILE_SIZE) {
+			size_t n = std::min<size_t>(CONVERSION_TILE_SIZE, end - i);
+			generateRandom(spec, i, tileR, n);
+			kernels.unary(UnaryOp::Scale, tileR, tileR, n, alpha);
+			convertToFloat(dtype, pa + i * elementSize, tileA, n);
+			kernels.binary(op, tileA, tileR, tileC, n);
+			convertFromFloat(dtype, tileC, pc + i * elementSize, n);
+		}
+	});
+}
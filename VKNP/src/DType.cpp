@@ -0,0 +1,233 @@
+#include "DType.hpp"
+
+#include <stdexcept>
+#include <cstring>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VKNP_X86 1
+#endif
+
+
+
+// #################################################################################################
+// ###   DType: Properties
+// #################################################################################################
+
+
+size_t getDTypeSize(DType dtype) {
+	switch (dtype) {
+		case DType::Float32:  return 4;
+		case DType::Float16:  return 2;
+		case DType::BFloat16: return 2;
+	}
+	throw std::runtime_error("Unknown dtype");
+}
+
+
+const char* getDTypeName(DType dtype) {
+	switch (dtype) {
+		case DType::Float32:  return "float32";
+		case DType::Float16:  return "float16";
+		case DType::BFloat16: return "bfloat16";
+	}
+	throw std::runtime_error("Unknown dtype");
+}
+
+
+const char* getDTypeSuffix(DType dtype) {
+	switch (dtype) {
+		case DType::Float32:  return "f32";
+		case DType::Float16:  return "f16";
+		case DType::BFloat16: return "bf16";
+	}
+	throw std::runtime_error("Unknown dtype");
+}
+
+
+// #################################################################################################
+// ###   DType: Scalar conversions
+// #################################################################################################
+
+
+uint16_t floatToHalf(float value) {
+	uint32_t bits = std::bit_cast<uint32_t>(value);
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	uint32_t exponent = (bits >> 23) & 0xFFu;
+	uint32_t mantissa = bits & 0x7FFFFFu;
+
+	// NaN and infinity
+	if (exponent == 0xFFu) {
+		return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+	}
+
+	int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+	// Overflow -> infinity
+	if (halfExponent >= 0x1F) {
+		return static_cast<uint16_t>(sign | 0x7C00u);
+	}
+
+	// Subnormal or zero
+	if (halfExponent <= 0) {
+		if (halfExponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000u;
+		uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	// Normal: round the 13 dropped bits to nearest even (a carry may bump the exponent, up to infinity)
+	uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1FFFu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+		half++;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
+
+
+float halfToFloat(uint16_t value) {
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+	uint32_t exponent = (value >> 10) & 0x1Fu;
+	uint32_t mantissa = value & 0x3FFu;
+
+	uint32_t bits;
+	if (exponent == 0x1Fu) {
+		bits = sign | 0x7F800000u | (mantissa << 13);			// NaN and infinity
+	} else if (exponent != 0) {
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	} else if (mantissa == 0) {
+		bits = sign;											// Zero
+	} else {
+		// Subnormal: normalize the mantissa
+		exponent = 127 - 15 + 1;
+		while ((mantissa & 0x400u) == 0) {
+			mantissa <<= 1;
+			exponent--;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+	}
+	return std::bit_cast<float>(bits);
+}
+
+
+uint16_t floatToBFloat16(float value) {
+	uint32_t bits = std::bit_cast<uint32_t>(value);
+	if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+		return static_cast<uint16_t>((bits >> 16) | 0x40u);		// Keep NaNs quiet
+	}
+	bits += 0x7FFFu + ((bits >> 16) & 1u);
+	return static_cast<uint16_t>(bits >> 16);
+}
+
+
+float bfloat16ToFloat(uint16_t value) {
+	return std::bit_cast<float>(static_cast<uint32_t>(value) << 16);
+}
+
+
+// #################################################################################################
+// ###   DType: Bulk conversions
+// #################################################################################################
+
+
+#ifdef VKNP_X86
+
+__attribute__((target("avx2,f16c")))
+static size_t halfToFloatF16C(const uint16_t* src, float* dst, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+	}
+	return i;
+}
+
+
+__attribute__((target("avx2,f16c")))
+static size_t floatToHalfF16C(const float* src, uint16_t* dst, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+	}
+	return i;
+}
+
+
+static bool hasF16C() {
+	static const bool supported = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+	}();
+	return supported;
+}
+
+#endif
+
+
+void convertToFloat(DType dtype, const void* src, float* dst, size_t count) {
+	switch (dtype) {
+		case DType::Float32:
+			std::memcpy(dst, src, count * sizeof(float));
+			break;
+		case DType::Float16: {
+			const uint16_t* half = static_cast<const uint16_t*>(src);
+			size_t i = 0;
+#ifdef VKNP_X86
+			if (hasF16C()) {
+				i = halfToFloatF16C(half, dst, count);
+			}
+#endif
+			for (; i < count; i++) {
+				dst[i] = halfToFloat(half[i]);
+			}
+			break;
+		}
+		case DType::BFloat16: {
+			const uint16_t* bf16 = static_cast<const uint16_t*>(src);
+			for (size_t i = 0; i < count; i++) {
+				dst[i] = bfloat16ToFloat(bf16[i]);
+			}
+			break;
+		}
+	}
+}
+
+
+void convertFromFloat(DType dtype, const float* src, void* dst, size_t count) {
+	switch (dtype) {
+		case DType::Float32:
+			std::memcpy(dst, src, count * sizeof(float));
+			break;
+		case DType::Float16: {
+			uint16_t* half = static_cast<uint16_t*>(dst);
+			size_t i = 0;
+#ifdef VKNP_X86
+			if (hasF16C()) {
+				i = floatToHalfF16C(src, half, count);
+			}
+#endif
+			for (; i < count; i++) {
+				half[i] = floatToHalf(src[i]);
+			}
+			break;
+		}
+		case DType::BFloat16: {
+			uint16_t* bf16 = static_cast<uint16_t*>(dst);
+			for (size_t i = 0; i < count; i++) {
+				bf16[i] = floatToBFloat16(src[i]);
+			}
+			break;
+		}
+	}
+}
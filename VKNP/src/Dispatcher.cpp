@@ -0,0 +1,493 @@
+#include "Dispatcher.hpp"
+#include "VulkanContext.hpp"
+#include "MemoryManager.hpp"
+#include "KernelManager.hpp"
+#include "Broadcast.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+
+
+// #################################################################################################
+// ###   CostModel
+// #################################################################################################
+
+
+double CostModel::estimateCpu(double bytes, double flops, double deviceBytes) const {
+	return bytes / cpuBandwidth + flops / cpuFlops + deviceBytes / transferBandwidth;
+}
+
+
+double CostModel::estimateDevice(double bytes, double flops, double hostBytes) const {
+	return deviceLaunchLatency + bytes / deviceBandwidth + flops / deviceFlops + hostBytes / transferBandwidth;
+}
+
+
+// #################################################################################################
+// ###   Dispatcher: Singleton implementation
+// #################################################################################################
+
+
+// Singleton access
+Dispatcher& Dispatcher::getDispatcher() {
+	static Dispatcher s_instance;
+	return s_instance;
+}
+
+
+void Dispatcher::init() {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+
+	if (!cpuBackend) {
+		cpuBackend = std::make_unique<CpuBackend>();
+	}
+
+	// The context throws if there is no usable GPU: keep the CPU backend only
+	try {
+		VulkanContext& context = VulkanContext::getContext();
+		MemoryManager::getManager().init(&context);
+		KernelManager::getManager().init(&context);
+		vulkanBackend = std::make_unique<VulkanBackend>();
+	} catch (const std::runtime_error& e) {
+		std::cerr << "VKNP: Vulkan unavailable, using the CPU backend (" << e.what() << ")" << std::endl;
+		vulkanBackend.reset();
+	}
+}
+
+
+void Dispatcher::destroy() {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+
+	if (vulkanBackend) {
+		KernelManager::getManager().destroy();
+		vulkanBackend.reset();
+	}
+	cpuBackend.reset();
+}
+
+
+CpuBackend& Dispatcher::getCpuBackend() {
+	if (!cpuBackend) {
+		throw std::runtime_error("Dispatcher not initialized");
+	}
+	return *cpuBackend;
+}
+
+
+void Dispatcher::setPreference(BackendPreference newPreference) {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+	preference = newPreference;
+}
+
+
+void Dispatcher::setCostModel(const CostModel& model) {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+	costModel = model;
+}
+
+
+// #################################################################################################
+// ###   Dispatcher: Backend selection
+// #################################################################################################
+
+
+Backend& Dispatcher::selectBackend(const std::vector<const Tensor*>& inputs, DType outputDType, size_t outputElements, double flops) {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+
+	if (!cpuBackend) {
+		throw std::runtime_error("Dispatcher not initialized");
+	}
+
+	// 16-bit kernels need 16-bit storage buffer access on the device
+	bool uses16Bit = getDTypeSize(outputDType) == 2;
+	for (const Tensor* input : inputs) {
+		uses16Bit |= getDTypeSize(input->getDType()) == 2;
+	}
+	bool deviceSupported = vulkanBackend != nullptr &&
+		(!uses16Bit || VulkanContext::getContext().getDeviceFeatures()[selectDevice(inputs)].storageBuffer16BitAccess);
+
+	Backend* backend = cpuBackend.get();
+	if (deviceSupported) {
+		switch (preference) {
+			case BackendPreference::Cpu:
+				break;
+			case BackendPreference::Vulkan:
+				backend = vulkanBackend.get();
+				break;
+			case BackendPreference::Auto: {
+				// Memory traffic and location of the operands
+				double bytes = static_cast<double>(outputElements * getDTypeSize(outputDType));
+				double hostBytes = 0.0;
+				double deviceBytes = 0.0;
+				for (const Tensor* input : inputs) {
+					bytes += static_cast<double>(input->getByteSize());
+					(input->isHost() ? hostBytes : deviceBytes) += static_cast<double>(input->getByteSize());
+				}
+
+				if (outputElements >= costModel.minDeviceElements &&
+					costModel.estimateDevice(bytes, flops, hostBytes) < costModel.estimateCpu(bytes, flops, deviceBytes)) {
+					backend = vulkanBackend.get();
+				}
+				break;
+			}
+		}
+	} else if (preference == BackendPreference::Vulkan) {
+		throw std::runtime_error(vulkanBackend ? "Vulkan backend requested but the device doesn't support 16-bit storage buffers"
+											   : "Vulkan backend requested but no Vulkan device is available");
+	}
+
+	lastBackend = backend->getType();
+	return *backend;
+}
+
+
+// Run on the device holding the first device operand
+uint32_t Dispatcher::selectDevice(const std::vector<const Tensor*>& inputs) const {
+	for (const Tensor* input : inputs) {
+		if (!input->isHost()) {
+			return input->getDeviceIndex();
+		}
+	}
+	return 0;
+}
+
+
+// #################################################################################################
+// ###   Dispatcher: Operations
+// #################################################################################################
+
+
+// Operands of different shapes are broadcast by the backends, without expanded copies
+Tensor Dispatcher::runBinary(BinaryOp op, const Tensor& a, const Tensor& b) {
+	if (a.getDType() != b.getDType()) {
+		throw std::runtime_error("Elementwise operation on tensors of different dtypes");
+	}
+	std::vector<size_t> shape = broadcastShapes(a.getShape(), b.getShape());
+	size_t count = 1;
+	for (size_t dim : shape) {
+		count *= dim;
+	}
+
+	Backend& backend = selectBackend({ &a, &b }, a.getDType(), count, static_cast<double>(count));
+	TensorLocation location = backend.getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	uint32_t deviceIndex = selectDevice({ &a, &b });
+
+	Tensor lhs = a.to(location, deviceIndex);
+	Tensor rhs = b.to(location, deviceIndex);
+	Tensor out = Tensor::empty(shape, location, deviceIndex, a.getDType());
+	backend.binary(op, lhs, rhs, out);
+	return out;
+}
+
+
+Tensor Dispatcher::runUnary(UnaryOp op, const Tensor& a, float alpha) {
+	Backend& backend = selectBackend({ &a }, a.getDType(), a.getElementCount(), static_cast<double>(a.getElementCount()));
+	TensorLocation location = backend.getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	uint32_t deviceIndex = selectDevice({ &a });
+
+	Tensor input = a.to(location, deviceIndex);
+	Tensor out = Tensor::empty(a.getShape(), location, deviceIndex, a.getDType());
+	backend.unary(op, input, out, alpha);
+	return out;
+}
+
+
+Tensor Dispatcher::add(const Tensor& a, const Tensor& b) { return runBinary(BinaryOp::Add, a, b); }
+Tensor Dispatcher::sub(const Tensor& a, const Tensor& b) { return runBinary(BinaryOp::Sub, a, b); }
+Tensor Dispatcher::mul(const Tensor& a, const Tensor& b) { return runBinary(BinaryOp::Mul, a, b); }
+Tensor Dispatcher::div(const Tensor& a, const Tensor& b) { return runBinary(BinaryOp::Div, a, b); }
+
+Tensor Dispatcher::relu(const Tensor& a) { return runUnary(UnaryOp::Relu, a, 1.0f); }
+Tensor Dispatcher::neg(const Tensor& a) { return runUnary(UnaryOp::Neg, a, 1.0f); }
+Tensor Dispatcher::exp(const Tensor& a) { return runUnary(UnaryOp::Exp, a, 1.0f); }
+Tensor Dispatcher::scale(const Tensor& a, float alpha) { return runUnary(UnaryOp::Scale, a, alpha); }
+
+
+Tensor Dispatcher::matmul(const Tensor& a, const Tensor& b) {
+	if (a.getShape().size() != 2 || b.getShape().size() != 2 || a.getShape()[1] != b.getShape()[0]) {
+		throw std::runtime_error("Matrix multiplication requires [M, K] x [K, N] tensors");
+	}
+	if (a.getDType() != b.getDType()) {
+		throw std::runtime_error("Matrix multiplication on tensors of different dtypes");
+	}
+	size_t M = a.getShape()[0];
+	size_t K = a.getShape()[1];
+	size_t N = b.getShape()[1];
+
+	Backend& backend = selectBackend({ &a, &b }, a.getDType(), M * N, 2.0 * M * N * K);
+	TensorLocation location = backend.getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	uint32_t deviceIndex = selectDevice({ &a, &b });
+
+	Tensor lhs = a.to(location, deviceIndex);
+	Tensor rhs = b.to(location, deviceIndex);
+	Tensor out = Tensor::empty({ M, N }, location, deviceIndex, a.getDType());
+	backend.matmul(lhs, rhs, out);
+	return out;
+}
+
+
+Tensor Dispatcher::cast(const Tensor& a, DType dtype) {
+	if (a.getDType() == dtype) {
+		return a;
+	}
+
+	Backend& backend = selectBackend({ &a }, dtype, a.getElementCount(), 0.0);
+	TensorLocation location = backend.getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	uint32_t deviceIndex = selectDevice({ &a });
+
+	Tensor input = a.to(location, deviceIndex);
+	Tensor out = Tensor::empty(a.getShape(), location, deviceIndex, dtype);
+	backend.convert(input, out);
+	return out;
+}
+
+
+Tensor Dispatcher::random(const std::vector<size_t>& shape, const RandomSpec& spec, TensorLocation location,
+						  uint32_t deviceIndex, DType dtype) {
+	Backend* backend;
+	{
+		std::lock_guard<std::mutex> lock(dispatcherMutex);
+		if (!cpuBackend) {
+			throw std::runtime_error("Dispatcher not initialized");
+		}
+
+		if (location == TensorLocation::Device && vulkanBackend != nullptr && deviceIndex >= VulkanContext::getContext().getDeviceCount()) {
+			throw std::runtime_error("Unable to generate a random tensor on an invalid device index");
+		}
+
+		// Generate on the target device when possible, the CPU produces the same values otherwise
+		bool onDevice = location == TensorLocation::Device && vulkanBackend != nullptr && preference != BackendPreference::Cpu &&
+			(getDTypeSize(dtype) != 2 || VulkanContext::getContext().getDeviceFeatures()[deviceIndex].storageBuffer16BitAccess);
+		backend = onDevice ? static_cast<Backend*>(vulkanBackend.get()) : cpuBackend.get();
+		lastBackend = backend->getType();
+	}
+
+	TensorLocation generated = backend->getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	Tensor out = Tensor::empty(shape, generated, deviceIndex, dtype);
+	backend->random(spec, out);
+	return out.to(location, deviceIndex);
+}
+
+
+Tensor Dispatcher::randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha) {
+	// Same traffic as a unary operation
+	Backend& backend = selectBackend({ &a }, a.getDType(), a.getElementCount(), static_cast<double>(a.getElementCount()));
+	TensorLocation location = backend.getType() == BackendType::Cpu ? TensorLocation::Host : TensorLocation::Device;
+	uint32_t deviceIndex = selectDevice({ &a });
+
+	Tensor input = a.to(location, deviceIndex);
+	Tensor out = Tensor::empty(a.getShape(), location, deviceIndex, a.getDType());
+	backend.randomBinary(op, input, spec, alpha, out);
+	return out;
+}
+
+
+Tensor Dispatcher::dropout(const Tensor& a, float probability, uint64_t seed, uint64_t offset) {
+	if (!(probability >= 0.0f && probability < 1.0f)) {
+		throw std::runtime_error("Dropout probability must be in [0, 1)");
+	}
+	float keep = 1.0f - probability;
+	return randomBinary(BinaryOp::Mul, a, RandomSpec::bernoulli(keep, seed, offset), 1.0f / keep);
+}
+
+
+// #################################################################################################
+// ###   Dispatcher: Sharded operations
+// #################################################################################################
+
+
+VulkanBackend& Dispatcher::selectShardBackend(const std::vector<const ShardedTensor*>& inputs) {
+	std::lock_guard<std::mutex> lock(dispatcherMutex);
+
+	if (!vulkanBackend) {
+		throw std::runtime_error("Sharded operations require a Vulkan device");
+	}
+	for (const ShardedTensor* input : inputs) {
+		if (getDTypeSize(input->getDType()) != 2) {
+			continue;
+		}
+		for (uint32_t deviceIndex : input->getDeviceIndices()) {
+			if (!VulkanContext::getContext().getDeviceFeatures()[deviceIndex].storageBuffer16BitAccess) {
+				throw std::runtime_error("Device " + std::to_string(deviceIndex) + " doesn't support 16-bit storage buffers");
+			}
+		}
+	}
+
+	lastBackend = BackendType::Vulkan;
+	return *vulkanBackend;
+}
+
+
+ShardedTensor Dispatcher::runShardedBinary(BinaryOp op, const ShardedTensor& a, const ShardedTensor& b) {
+	if (!a.isAlignedWith(b)) {
+		throw std::runtime_error("Sharded elementwise operation on operands with different layouts");
+	}
+	if (a.getDType() != b.getDType()) {
+		throw std::runtime_error("Elementwise operation on tensors of different dtypes");
+	}
+	// The sum (or difference) of partial results is a partial result of the sum
+	if (a.getLayout() == ShardLayout::Partial && op != BinaryOp::Add && op != BinaryOp::Sub) {
+		throw std::runtime_error("Only additions and subtractions are supported on partial results");
+	}
+
+	VulkanBackend& backend = selectShardBackend({ &a, &b });
+	std::vector<Tensor> shards(a.getShardCount());
+	runOnShards(shards.size(), [&](size_t i) {
+		const Tensor& lhs = a.getShard(i);
+		Tensor out = Tensor::empty(lhs.getShape(), TensorLocation::Device, lhs.getDeviceIndex(), lhs.getDType());
+		backend.binary(op, lhs, b.getShard(i), out);
+		shards[i] = std::move(out);
+	});
+	return ShardedTensor::fromShards(std::move(shards), a.getLayout(), a.getAxis());
+}
+
+
+ShardedTensor Dispatcher::runShardedUnary(UnaryOp op, const ShardedTensor& a, float alpha) {
+	if (a.getLayout() == ShardLayout::Partial && op != UnaryOp::Neg && op != UnaryOp::Scale) {
+		throw std::runtime_error("Only linear operations are supported on partial results");
+	}
+
+	VulkanBackend& backend = selectShardBackend({ &a });
+	std::vector<Tensor> shards(a.getShardCount());
+	runOnShards(shards.size(), [&](size_t i) {
+		const Tensor& input = a.getShard(i);
+		Tensor out = Tensor::empty(input.getShape(), TensorLocation::Device, input.getDeviceIndex(), input.getDType());
+		backend.unary(op, input, out, alpha);
+		shards[i] = std::move(out);
+	});
+	return ShardedTensor::fromShards(std::move(shards), a.getLayout(), a.getAxis());
+}
+
+
+ShardedTensor Dispatcher::add(const ShardedTensor& a, const ShardedTensor& b) { return runShardedBinary(BinaryOp::Add, a, b); }
+ShardedTensor Dispatcher::sub(const ShardedTensor& a, const ShardedTensor& b) { return runShardedBinary(BinaryOp::Sub, a, b); }
+ShardedTensor Dispatcher::mul(const ShardedTensor& a, const ShardedTensor& b) { return runShardedBinary(BinaryOp::Mul, a, b); }
+ShardedTensor Dispatcher::div(const ShardedTensor& a, const ShardedTensor& b) { return runShardedBinary(BinaryOp::Div, a, b); }
+
+ShardedTensor Dispatcher::relu(const ShardedTensor& a) { return runShardedUnary(UnaryOp::Relu, a, 1.0f); }
+ShardedTensor Dispatcher::neg(const ShardedTensor& a) { return runShardedUnary(UnaryOp::Neg, a, 1.0f); }
+ShardedTensor Dispatcher::exp(const ShardedTensor& a) { return runShardedUnary(UnaryOp::Exp, a, 1.0f); }
+ShardedTensor Dispatcher::scale(const ShardedTensor& a, float alpha) { return runShardedUnary(UnaryOp::Scale, a, alpha); }
+
+
+ShardedTensor Dispatcher::matmul(const ShardedTensor& a, const ShardedTensor& b) {
+	if (a.getShape().size() != 2 || b.getShape().size() != 2 || a.getShape()[1] != b.getShape()[0]) {
+		throw std::runtime_error("Matrix multiplication requires [M, K] x [K, N] tensors");
+	}
+	if (a.getDType() != b.getDType()) {
+		throw std::runtime_error("Matrix multiplication on tensors of different dtypes");
+	}
+
+	auto isSplit = [](const ShardedTensor& t, size_t axis) { return t.getLayout() == ShardLayout::Split && t.getAxis() == axis; };
+	auto isReplicated = [](const ShardedTensor& t) { return t.getLayout() == ShardLayout::Replicated; };
+
+	// The split operand drives the shards, the other one is paired by device
+	ShardLayout layout;
+	size_t axis = 0;
+	bool driverIsA = true;
+	if (isSplit(a, 0) && isReplicated(b)) {
+		layout = ShardLayout::Split;
+	} else if (isReplicated(a) && isSplit(b, 1)) {
+		layout = ShardLayout::Split;
+		axis = 1;
+		driverIsA = false;
+	} else if (isSplit(a, 1) && isSplit(b, 0)) {
+		layout = ShardLayout::Partial;
+	} else if (isReplicated(a) && isReplicated(b)) {
+		layout = ShardLayout::Replicated;
+	} else {
+		throw std::runtime_error("Unsupported sharding for a matrix multiplication");
+	}
+
+	const ShardedTensor& driver = driverIsA ? a : b;
+	const ShardedTensor& other = driverIsA ? b : a;
+	std::vector<size_t> pairs(driver.getShardCount());
+	for (size_t i = 0; i < pairs.size(); i++) {
+		uint32_t deviceIndex = driver.getShard(i).getDeviceIndex();
+		if (layout == ShardLayout::Partial) {
+			// Both inner dimensions must be split the same way
+			if (i >= other.getShardCount() || other.getShard(i).getDeviceIndex() != deviceIndex ||
+				driver.getShard(i).getShape()[1] != other.getShard(i).getShape()[0] || driver.getShardCount() != other.getShardCount()) {
+				throw std::runtime_error("Matrix multiplication operands with misaligned inner dimension shards");
+			}
+			pairs[i] = i;
+			continue;
+		}
+
+		std::vector<uint32_t> otherDevices = other.getDeviceIndices();
+		auto it = std::find(otherDevices.begin(), otherDevices.end(), deviceIndex);
+		if (it == otherDevices.end()) {
+			throw std::runtime_error("Matrix multiplication operand missing on device " + std::to_string(deviceIndex));
+		}
+		pairs[i] = static_cast<size_t>(it - otherDevices.begin());
+	}
+
+	VulkanBackend& backend = selectShardBackend({ &a, &b });
+	std::vector<Tensor> shards(pairs.size());
+	runOnShards(shards.size(), [&](size_t i) {
+		const Tensor& lhs = driverIsA ? driver.getShard(i) : other.getShard(pairs[i]);
+		const Tensor& rhs = driverIsA ? other.getShard(pairs[i]) : driver.getShard(i);
+
+		Tensor out = Tensor::empty({ lhs.getShape()[0], rhs.getShape()[1] }, TensorLocation::Device, lhs.getDeviceIndex(), lhs.getDType());
+		backend.matmul(lhs, rhs, out);
+		shards[i] = std::move(out);
+	});
+	return ShardedTensor::fromShards(std::move(shards), layout, axis);
+}
+
+
+// #################################################################################################
+// ###   Dispatcher: Collectives
+// #################################################################################################
+
+
+ShardedTensor Dispatcher::allReduce(const ShardedTensor& partials) {
+	if (partials.getLayout() == ShardLayout::Replicated) {
+		return partials;
+	}
+	if (partials.getLayout() != ShardLayout::Partial) {
+		throw std::runtime_error("All-reduce expects partial results");
+	}
+	CpuBackend& cpu = getCpuBackend();
+	DType dtype = partials.getDType();
+
+	// Download all the partial results concurrently
+	std::vector<Tensor> hostPartials(partials.getShardCount());
+	runOnShards(hostPartials.size(), [&](size_t i) {
+		hostPartials[i] = partials.getShard(i).to(TensorLocation::Host);
+	});
+
+	// Accumulate in float32 on the host
+	Tensor sum = Tensor::empty(partials.getShape(), TensorLocation::Host, 0, DType::Float32);
+	cpu.convert(hostPartials[0], sum);
+	Tensor widened = dtype == DType::Float32 ? Tensor() : Tensor::empty(partials.getShape(), TensorLocation::Host, 0, DType::Float32);
+	for (size_t i = 1; i < hostPartials.size(); i++) {
+		if (dtype == DType::Float32) {
+			cpu.binary(BinaryOp::Add, sum, hostPartials[i], sum);
+		} else {
+			cpu.convert(hostPartials[i], widened);
+			cpu.binary(BinaryOp::Add, sum, widened, sum);
+		}
+	}
+
+	Tensor result = sum;
+	if (dtype != DType::Float32) {
+		result = Tensor::empty(partials.getShape(), TensorLocation::Host, 0, dtype);
+		cpu.convert(sum, result);
+	}
+	return ShardedTensor::replicate(result, partials.getDeviceIndices());
+}
+
+
+ShardedTensor Dispatcher::allGather(const ShardedTensor& tensor) {
+	if (tensor.getLayout() == ShardLayout::Replicated) {
+		return tensor;
+	}
+	if (tensor.getLayout() != ShardLayout::Split) {
+		throw std::runtime_error("All-gather expects a split tensor, partial results must be reduced");
+	}
+	return ShardedTensor::replicate(tensor.gather(TensorLocation::Host), tensor.getDeviceIndices());
+}
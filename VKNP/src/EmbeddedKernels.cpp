@@ -0,0 +1,55 @@
+#include "EmbeddedKernels.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+// Generated at build time by cmake/EmbedKernels.cmake: the kernel_<name> arrays and kernelTable
+#include "EmbeddedKernelTable.inc"
+
+#define SPIRV_MAGIC_NUMBER 0x07230203
+#define SPIRV_HEADER_WORDS 5
+
+
+
+// #################################################################################################
+// ###   Compile-time lookup and checks
+// #################################################################################################
+
+
+static constexpr const EmbeddedKernel* findKernel(std::string_view name) {
+	auto it = std::ranges::lower_bound(kernelTable, name, {}, &EmbeddedKernel::name);
+	return (it != std::end(kernelTable) && it->name == name) ? it : nullptr;
+}
+
+
+static_assert(std::ranges::is_sorted(kernelTable, {}, &EmbeddedKernel::name), "The kernel table must be sorted by name");
+static_assert(std::ranges::adjacent_find(kernelTable, {}, &EmbeddedKernel::name) == std::end(kernelTable), "Duplicate kernel names");
+static_assert(std::ranges::all_of(kernelTable, [](const EmbeddedKernel& kernel) {
+	return kernel.code.size() > SPIRV_HEADER_WORDS && kernel.code[0] == SPIRV_MAGIC_NUMBER;
+}), "Invalid SPIR-V module");
+
+// A few kernels the backends can't run without
+static_assert(findKernel("elementwise_binary_f32") != nullptr && findKernel("matmul_f32") != nullptr &&
+			  findKernel("convert_f32_f16") != nullptr && findKernel("scan") != nullptr, "Missing kernels");
+
+
+
+// #################################################################################################
+// ###   Runtime access
+// #################################################################################################
+
+
+std::span<const EmbeddedKernel> getEmbeddedKernels() {
+	return kernelTable;
+}
+
+
+std::span<const uint32_t> getEmbeddedKernel(std::string_view name) {
+	const EmbeddedKernel* kernel = findKernel(name);
+	if (kernel == nullptr) {
+		throw std::runtime_error("Unknown kernel " + std::string(name));
+	}
+	return kernel->code;
+}
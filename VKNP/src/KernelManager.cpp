@@ -0,0 +1,318 @@
+#include "KernelManager.hpp"
+#include "MemoryManager.hpp"
+#include "EmbeddedKernels.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#define MAX_GROUP_COUNT 65535	// Minimum maxComputeWorkGroupCount[0] guaranteed by the Vulkan specification
+
+
+// #################################################################################################
+// ###   KernelManager: Singleton implementation
+// #################################################################################################
+
+
+// Singleton access
+KernelManager& KernelManager::getManager() {
+	static KernelManager s_instance;
+	return s_instance;
+}
+
+
+void KernelManager::init(VulkanContext* context) {
+	std::lock_guard<std::mutex> lock(kernelMutex);
+	if (context == nullptr) {
+		throw std::runtime_error("Kernel Manager initialized with an invalid Vulkan context");
+	}
+	vkContext = context;
+}
+
+
+void KernelManager::destroy() {
+	std::lock_guard<std::mutex> lock(kernelMutex);
+
+	for (auto& kv : kernels) {
+		destroyKernel(kv.second);
+	}
+	kernels.clear();
+}
+
+
+// #################################################################################################
+// ###   KernelManager: Dispatch
+// #################################################################################################
+
+
+uint32_t KernelManager::getGroupCount(size_t elementCount, uint32_t workgroupSize) {
+	size_t groups = (elementCount + workgroupSize - 1) / workgroupSize;
+	return static_cast<uint32_t>(std::clamp<size_t>(groups, 1, MAX_GROUP_COUNT));
+}
+
+
+void KernelManager::dispatch(uint32_t deviceIndex, const std::string& kernelName, const std::vector<MemoryHandle>& buffers,
+							 const void* pushConstants, uint32_t pushConstantsSize,
+							 uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	if (pushConstantsSize > MAX_PUSH_CONSTANTS_SIZE) {
+		throw std::runtime_error("Push constants of kernel " + kernelName + " exceed " + std::to_string(MAX_PUSH_CONSTANTS_SIZE) + " bytes");
+	}
+
+	KernelLaunch launch;
+	launch.kernelName = kernelName;
+	launch.buffers = buffers;
+	if (pushConstantsSize > 0) {
+		std::memcpy(launch.pushConstants.data(), pushConstants, pushConstantsSize);
+	}
+	launch.pushConstantsSize = pushConstantsSize;
+	launch.groupCount[0] = groupCountX;
+	launch.groupCount[1] = groupCountY;
+	launch.groupCount[2] = groupCountZ;
+	dispatchBatch(deviceIndex, { launch });
+}
+
+
+void KernelManager::dispatchBatch(uint32_t deviceIndex, const std::vector<KernelLaunch>& launches) {
+	if (launches.empty()) {
+		return;
+	}
+
+	std::vector<Kernel*> batchKernels;
+	uint32_t descriptorCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(kernelMutex);
+		for (const KernelLaunch& launch : launches) {
+			if (launch.pushConstantsSize > MAX_PUSH_CONSTANTS_SIZE) {
+				throw std::runtime_error("Push constants of kernel " + launch.kernelName + " exceed " + std::to_string(MAX_PUSH_CONSTANTS_SIZE) + " bytes");
+			}
+			Kernel* kernel = &getKernel(deviceIndex, launch.kernelName, static_cast<uint32_t>(launch.buffers.size()), launch.specializationConstants);
+			if (kernel->bindingCount != launch.buffers.size()) {
+				throw std::runtime_error("Kernel " + launch.kernelName + " expects " + std::to_string(kernel->bindingCount) + " buffers");
+			}
+			batchKernels.push_back(kernel);
+			descriptorCount += kernel->bindingCount;
+		}
+	}
+	VkDevice device = batchKernels[0]->device;
+
+	// Buffers must not be relocated until the kernels are submitted (later copies are ordered after them by the barrier)
+	// The lock is released before waiting, so that kernels run concurrently on different devices
+	auto& memMgr = MemoryManager::getManager();
+	auto bufferLock = memMgr.lockBuffers();
+
+	std::vector<std::vector<VkDescriptorBufferInfo>> bufferInfos(launches.size());
+	for (size_t l = 0; l < launches.size(); l++) {
+		for (const MemoryHandle& handle : launches[l].buffers) {
+			BufferInfo info = memMgr.getBufferInfo(handle);
+			if (info.deviceIndex != deviceIndex) {
+				throw std::runtime_error("Kernel " + launches[l].kernelName + " dispatched with a buffer from another device");
+			}
+			bufferInfos[l].push_back({ info.buffer, 0, VK_WHOLE_SIZE });
+		}
+	}
+
+	// Create the descriptor sets of this batch
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = std::max<uint32_t>(descriptorCount, 1);
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = static_cast<uint32_t>(launches.size());
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	VkDescriptorPool descriptorPool;
+	if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a descriptor pool for kernel " + launches[0].kernelName);
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	for (Kernel* kernel : batchKernels) {
+		setLayouts.push_back(kernel->setLayout);
+	}
+
+	VkDescriptorSetAllocateInfo setInfo{};
+	setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setInfo.descriptorPool = descriptorPool;
+	setInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+	setInfo.pSetLayouts = setLayouts.data();
+
+	std::vector<VkDescriptorSet> descriptorSets(launches.size());
+	if (vkAllocateDescriptorSets(device, &setInfo, descriptorSets.data()) != VK_SUCCESS) {
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		throw std::runtime_error("Failed to allocate the descriptor sets for kernel " + launches[0].kernelName);
+	}
+
+	std::vector<VkWriteDescriptorSet> writes;
+	for (size_t l = 0; l < launches.size(); l++) {
+		for (uint32_t i = 0; i < bufferInfos[l].size(); i++) {
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = descriptorSets[l];
+			write.dstBinding = i;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.pBufferInfo = &bufferInfos[l][i];
+			writes.push_back(write);
+		}
+	}
+	vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+	// Record and run the kernels
+	try {
+		Submission submission = vkContext->submit(deviceIndex, [&](VkCommandBuffer commandBuffer) {
+			for (size_t l = 0; l < launches.size(); l++) {
+				const KernelLaunch& launch = launches[l];
+				Kernel* kernel = batchKernels[l];
+
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipeline);
+				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipelineLayout,
+										0, 1, &descriptorSets[l], 0, nullptr);
+				if (launch.pushConstantsSize > 0) {
+					vkCmdPushConstants(commandBuffer, kernel->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+									   0, launch.pushConstantsSize, launch.pushConstants.data());
+				}
+				vkCmdDispatch(commandBuffer, launch.groupCount[0], launch.groupCount[1], launch.groupCount[2]);
+
+				// Make the results visible to the following kernels and commands
+				VkMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+									 0, 1, &barrier, 0, nullptr, 0, nullptr);
+			}
+		});
+		bufferLock.unlock();
+		vkContext->wait(submission);
+	} catch (...) {
+		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		throw;
+	}
+
+	vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+}
+
+
+// #################################################################################################
+// ###   KernelManager: Pipelines
+// #################################################################################################
+
+
+KernelManager::Kernel& KernelManager::getKernel(uint32_t deviceIndex, const std::string& kernelName, uint32_t bindingCount,
+												const std::vector<uint32_t>& specializationConstants) {
+	// Check initialization and device index
+	if (vkContext == nullptr) {
+		throw std::runtime_error("Kernel Manager not initialized");
+	}
+	if (deviceIndex >= vkContext->getDeviceCount()) {
+		throw std::runtime_error("Unable to create a kernel for an invalid device index");
+	}
+
+	auto key = std::make_tuple(deviceIndex, kernelName, specializationConstants);
+	auto it = kernels.find(key);
+	if (it != kernels.end()) {
+		return it->second;
+	}
+
+	Kernel kernel{};
+	kernel.device = vkContext->getDevices()[deviceIndex];
+	kernel.bindingCount = bindingCount;
+
+	// Create the shader module (SPIR-V embedded at build time)
+	std::span<const uint32_t> code = getEmbeddedKernel(kernelName);
+
+	VkShaderModuleCreateInfo moduleInfo{};
+	moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+	moduleInfo.pCode = code.data();
+
+	if (vkCreateShaderModule(kernel.device, &moduleInfo, nullptr, &kernel.module) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create the shader module of kernel " + kernelName);
+	}
+
+	// Create the descriptor set layout: one storage buffer per binding
+	std::vector<VkDescriptorSetLayoutBinding> bindings(bindingCount);
+	for (uint32_t i = 0; i < bindingCount; i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+	setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.bindingCount = bindingCount;
+	setLayoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(kernel.device, &setLayoutInfo, nullptr, &kernel.setLayout) != VK_SUCCESS) {
+		destroyKernel(kernel);
+		throw std::runtime_error("Failed to create the descriptor set layout of kernel " + kernelName);
+	}
+
+	// Create the pipeline layout: all kernels share the same push constant range
+	VkPushConstantRange pushRange{};
+	pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushRange.offset = 0;
+	pushRange.size = MAX_PUSH_CONSTANTS_SIZE;
+
+	VkPipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = 1;
+	layoutInfo.pSetLayouts = &kernel.setLayout;
+	layoutInfo.pushConstantRangeCount = 1;
+	layoutInfo.pPushConstantRanges = &pushRange;
+
+	if (vkCreatePipelineLayout(kernel.device, &layoutInfo, nullptr, &kernel.pipelineLayout) != VK_SUCCESS) {
+		destroyKernel(kernel);
+		throw std::runtime_error("Failed to create the pipeline layout of kernel " + kernelName);
+	}
+
+	// Specialization constants: 32-bit values for the constant_id 0..n-1
+	std::vector<VkSpecializationMapEntry> mapEntries(specializationConstants.size());
+	for (uint32_t i = 0; i < mapEntries.size(); i++) {
+		mapEntries[i].constantID = i;
+		mapEntries[i].offset = i * sizeof(uint32_t);
+		mapEntries[i].size = sizeof(uint32_t);
+	}
+
+	VkSpecializationInfo specializationInfo{};
+	specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+	specializationInfo.pMapEntries = mapEntries.data();
+	specializationInfo.dataSize = specializationConstants.size() * sizeof(uint32_t);
+	specializationInfo.pData = specializationConstants.data();
+
+	// Create the compute pipeline
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = kernel.module;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.stage.pSpecializationInfo = specializationConstants.empty() ? nullptr : &specializationInfo;
+	pipelineInfo.layout = kernel.pipelineLayout;
+
+	if (vkCreateComputePipelines(kernel.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &kernel.pipeline) != VK_SUCCESS) {
+		destroyKernel(kernel);
+		throw std::runtime_error("Failed to create the compute pipeline of kernel " + kernelName);
+	}
+
+	return kernels.emplace(key, kernel).first->second;
+}
+
+
+void KernelManager::destroyKernel(Kernel& kernel) {
+	if (kernel.pipeline != VK_NULL_HANDLE) {
+		vkDestroyPipeline(kernel.device, kernel.pipeline, nullptr);
+	}
+	if (kernel.pipelineLayout != VK_NULL_HANDLE) {
+		vkDestroyPipelineLayout(kernel.device, kernel.pipelineLayout, nullptr);
+	}
+	if (kernel.setLayout != VK_NULL_HANDLE) {
+		vkDestroyDescriptorSetLayout(kernel.device, kernel.setLayout, nullptr);
+	}
+	if (kernel.module != VK_NULL_HANDLE) {
+		vkDestroyShaderModule(kernel.device, kernel.module, nullptr);
+	}
+}
@@ -4,8 +4,11 @@
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 #define ALLOCATION_BLOCK_SIZE 4096
+#define MEMORY_BLOCK_SIZE (64ull << 20)							// Size of the blocks shared by small allocations
+#define DEDICATED_ALLOCATION_THRESHOLD (MEMORY_BLOCK_SIZE / 2)	// Larger allocations get their own block
 
 
 // #################################################################################################
@@ -47,6 +50,12 @@ void MemoryManager::destroy() {
 	cachedAllocations.clear();
 
 	lruCache.clear();
+
+	// Blocks are released with their last allocation, this only catches leftovers
+	for (auto& kv : memoryBlocks) {
+		vkFreeMemory(kv.second.device, kv.second.memory, nullptr);
+	}
+	memoryBlocks.clear();
 }
 
 
@@ -80,42 +89,15 @@ MemoryHandle MemoryManager::getBuffer(VkDeviceSize size, uint32_t requestedDevic
 			alloc.refCount++;
 			lruCache.erase(it);
 
-			// Move the buffer to activeAllocations
-			activeAllocations[alloc.id] = alloc;
-			cachedAllocations.erase(findit);
-
+			// Move the buffer to activeAllocations (alloc refers to the erased cache entry)
 			MemoryHandle handle;
 			handle.id = alloc.id;
+			activeAllocations[alloc.id] = alloc;
+			cachedAllocations.erase(findit);
 			return handle;
 		}
 	}
 
-	// Check if the cache needs to be emptied
-	VkPhysicalDevice physDevice = vkContext->getPhysicalDevices()[requestedDeviceIndex];
-    auto [usedMemory, totalMemory] = vkContext->getMemoryUsage(physDevice);
-    
-	VkDeviceSize freeMemory = totalMemory - usedMemory;
-	VkDeviceSize alignedSize = ((size + ALLOCATION_BLOCK_SIZE - 1) / ALLOCATION_BLOCK_SIZE) * ALLOCATION_BLOCK_SIZE;
-
-    if (freeMemory < alignedSize) {
-        // Compute total cache size
-        VkDeviceSize cacheSize = 0;
-        for (const auto& kv : cachedAllocations) {
-            cacheSize += kv.second.size;
-        }
-
-		// Check if enough memory can be freed from the cache
-		VkDeviceSize needed = alignedSize - freeMemory;
-        if (cacheSize >= needed) {
-            emptyCache(needed);
-        } else {
-			throw std::runtime_error("Insufficient GPU memory available to allocate buffer. "
-									 "Memory required: " + std::to_string(alignedSize) + " bytes, "
-									 "Memory available: " + std::to_string(freeMemory) + " bytes, "
-									 "Memory available (Cache): " + std::to_string(cacheSize) + " bytes.");
-        }
-    }
-
 	// Create a new buffer
 	return createAllocation(size, requestedDeviceIndex);
 }
@@ -160,6 +142,23 @@ void MemoryManager::releaseBuffer(const MemoryHandle& handle) {
 }
 
 
+BufferInfo MemoryManager::getBufferInfo(const MemoryHandle& handle) const {
+	std::lock_guard<std::recursive_mutex> lock(managerMutex);
+
+	// Check if the handle is valid
+	auto it = activeAllocations.find(handle.id);
+	if (it == activeAllocations.end()) {
+		throw std::runtime_error("Unable to get the information of an invalid buffer handle");
+	}
+
+	BufferInfo info;
+	info.buffer = it->second.buffer;
+	info.size = it->second.size;
+	info.deviceIndex = it->second.deviceIndex;
+	return info;
+}
+
+
 // #################################################################################################
 // ###   MemoryManager: Buffer management
 // #################################################################################################
@@ -205,6 +204,29 @@ void MemoryManager::emptyCache(VkDeviceSize bytesToFree) {
 }
 
 
+// Same as emptyCache, restricted to the cached buffers of one device (least recently used first)
+void MemoryManager::emptyCache(VkDeviceSize bytesToFree, uint32_t deviceIndex) {
+	std::lock_guard<std::recursive_mutex> lock(managerMutex);
+
+	VkDeviceSize freed = 0;
+	for (auto it = lruCache.begin(); it != lruCache.end() && (bytesToFree == 0 || freed < bytesToFree);) {
+		auto cached = cachedAllocations.find(*it);
+		if (cached == cachedAllocations.end()) {
+			throw std::runtime_error("Unable to find a cached buffer in the cache");
+		}
+		if (cached->second.deviceIndex != deviceIndex) {
+			++it;
+			continue;
+		}
+
+		freed += cached->second.size;
+		destroyAllocation(cached->first, true);
+		cachedAllocations.erase(cached);
+		it = lruCache.erase(it);
+	}
+}
+
+
 MemoryHandle MemoryManager::createAllocation(VkDeviceSize size, uint32_t deviceIndex) {
 	// Check initialization and device index
 	if (vkContext == nullptr) {
@@ -216,19 +238,74 @@ MemoryHandle MemoryManager::createAllocation(VkDeviceSize size, uint32_t deviceI
 
 	VkDevice device = vkContext->getDevices()[deviceIndex];
 
-	// Create the buffer
-	VkBuffer buffer;
-	VkDeviceMemory memory;
-	vkContext -> createBufferAndMemory(device, size, buffer, memory);
+	// Create the buffer and get its memory requirements
+	VkBuffer buffer = vkContext->createBuffer(device, size);
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(device, buffer, &requirements);
+
+	uint64_t blockId = 0;
+	VkDeviceSize offset = 0;
+	try {
+		uint32_t memoryTypeIndex = vkContext->findMemoryType(deviceIndex, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		bool dedicated = requirements.size >= DEDICATED_ALLOCATION_THRESHOLD;
+
+		// Look for a free range in the existing blocks
+		auto findRange = [&]() {
+			if (dedicated) {
+				return false;
+			}
+			for (auto& kv : memoryBlocks) {
+				MemoryBlock& block = kv.second;
+				if (!block.dedicated && block.deviceIndex == deviceIndex && block.memoryTypeIndex == memoryTypeIndex &&
+					placeInBlock(block, requirements, offset)) {
+					blockId = block.id;
+					return true;
+				}
+			}
+			return false;
+		};
+
+		if (!findRange()) {
+			VkDeviceSize alignedSize = ((requirements.size + ALLOCATION_BLOCK_SIZE - 1) / ALLOCATION_BLOCK_SIZE) * ALLOCATION_BLOCK_SIZE;
+
+			// Check if the cache needs to be emptied or the blocks compacted
+			VkDeviceSize freeMemory = getFreeDeviceMemory(deviceIndex);
+			if (freeMemory < alignedSize) {
+				reclaimDeviceMemory(deviceIndex, alignedSize);
+				freeMemory = getFreeDeviceMemory(deviceIndex);
+			}
+
+			// Reclaiming memory may have freed a suitable range
+			if (!findRange()) {
+				// Shrink the new shared block instead of evicting buffers if a full block doesn't fit
+				VkDeviceSize blockSize = dedicated ? alignedSize : std::clamp<VkDeviceSize>(freeMemory, alignedSize, MEMORY_BLOCK_SIZE);
+				blockId = createBlock(deviceIndex, memoryTypeIndex, blockSize, dedicated);
+				if (!placeInBlock(memoryBlocks.at(blockId), requirements, offset)) {
+					throw std::runtime_error("Unable to place a buffer in a new memory block");
+				}
+			}
+		}
+
+		// Bind the buffer to its range
+		if (vkBindBufferMemory(device, buffer, memoryBlocks.at(blockId).memory, offset) != VK_SUCCESS) {
+			freeRange(memoryBlocks.at(blockId), offset, requirements.size);
+			throw std::runtime_error("Failed to bind the buffer memory");
+		}
+	} catch (...) {
+		vkDestroyBuffer(device, buffer, nullptr);
+		throw;
+	}
 
 	// Create the allocation info
 	AllocationInfo info;
 	info.id = nextBufferId++;
 	info.buffer = buffer;
-	info.memory = memory;
 	info.device = device;
 	info.size = size;
 	info.deviceIndex = deviceIndex;
+	info.blockId = blockId;
+	info.offset = offset;
+	info.reservedSize = requirements.size;
 	info.refCount = 1;
 
 	activeAllocations[info.id] = info;
@@ -240,29 +317,521 @@ MemoryHandle MemoryManager::createAllocation(VkDeviceSize size, uint32_t deviceI
 
 
 void MemoryManager::destroyAllocation(uint64_t allocId, bool inCache) {
-	if (inCache) {
-		// Search for the allocation in cachedAllocations
-		auto itCached = cachedAllocations.find(allocId);
-		if (itCached != cachedAllocations.end()) {
-			AllocationInfo& info = itCached->second;
+	auto& allocations = inCache ? cachedAllocations : activeAllocations;
 
-			vkDestroyBuffer(info.device, info.buffer, nullptr);
-			vkFreeMemory(info.device, info.memory, nullptr);
+	auto it = allocations.find(allocId);
+	if (it == allocations.end()) {
+		// Allocation not found, for now don't throw an error
+		return;
+	}
+	AllocationInfo& info = it->second;
 
-			return;
+	vkDestroyBuffer(info.device, info.buffer, nullptr);
+
+	// Give the range back to its block, and release the block once it is empty
+	auto blockIt = memoryBlocks.find(info.blockId);
+	if (blockIt != memoryBlocks.end()) {
+		freeRange(blockIt->second, info.offset, info.reservedSize);
+		if (blockIt->second.allocationCount == 0) {
+			destroyBlock(info.blockId);
 		}
-	} else {
-		// Search for the allocation in activeAllocations
-		auto itActive = activeAllocations.find(allocId);
-		if (itActive != activeAllocations.end()) {
-			AllocationInfo& info = itActive->second;
+	}
+}
 
-			vkDestroyBuffer(info.device, info.buffer, nullptr);
-			vkFreeMemory(info.device, info.memory, nullptr);
 
+MemoryManager::AllocationInfo* MemoryManager::findAllocation(uint64_t allocId) {
+	auto itActive = activeAllocations.find(allocId);
+	if (itActive != activeAllocations.end()) {
+		return &itActive->second;
+	}
+	auto itCached = cachedAllocations.find(allocId);
+	if (itCached != cachedAllocations.end()) {
+		return &itCached->second;
+	}
+	return nullptr;
+}
+
+
+// Make room for a new block of the given size, first by emptying the cache, then by compacting the cached allocations
+// The gaps between active allocations are not recovered here: relocating them needs an explicit defragment(..., includeActive = true)
+void MemoryManager::reclaimDeviceMemory(uint32_t deviceIndex, VkDeviceSize size) {
+	VkDeviceSize freeMemory = getFreeDeviceMemory(deviceIndex);
+
+	// Compute the cache size on this device
+	VkDeviceSize cacheSize = 0;
+	for (const auto& kv : cachedAllocations) {
+		if (kv.second.deviceIndex == deviceIndex) {
+			cacheSize += kv.second.size;
+		}
+	}
+
+	// Check if enough memory can be recovered
+	if (freeMemory + cacheSize < size) {
+		throw std::runtime_error("Insufficient GPU memory available to allocate buffer. "
+								 "Memory required: " + std::to_string(size) + " bytes, "
+								 "Memory available: " + std::to_string(freeMemory) + " bytes, "
+								 "Memory available (Cache): " + std::to_string(cacheSize) + " bytes, "
+								 "Memory fragmented in active blocks: " + std::to_string(getFreeGapsSize(deviceIndex)) + " bytes.");
+	}
+
+	// 1) Evict the least recently used buffers of this device
+	if (cacheSize > 0) {
+		emptyCache(size - freeMemory, deviceIndex);
+		if (getFreeDeviceMemory(deviceIndex) >= size) {
 			return;
 		}
 	}
 
-	// Allocation not found, for now don't throw an error
-}
\ No newline at end of file
+	// 2) Move the remaining cached allocations out of their blocks so that these blocks are released
+	defragment(deviceIndex);
+	if (getFreeDeviceMemory(deviceIndex) >= size) {
+		return;
+	}
+
+	// 3) Last resort: drop the rest of the cache of this device (releases the blocks that couldn't be evacuated)
+	emptyCache(0, deviceIndex);
+	if (getFreeDeviceMemory(deviceIndex) < size) {
+		throw std::runtime_error("Insufficient GPU memory available to allocate buffer after emptying the cache. "
+								 "Memory required: " + std::to_string(size) + " bytes, "
+								 "Memory available: " + std::to_string(getFreeDeviceMemory(deviceIndex)) + " bytes.");
+	}
+}
+
+
+VkDeviceSize MemoryManager::getFreeDeviceMemory(uint32_t deviceIndex) const {
+	VkPhysicalDevice physDevice = vkContext->getPhysicalDevices()[deviceIndex];
+	auto [usedMemory, totalMemory] = vkContext->getMemoryUsage(physDevice);
+	return usedMemory >= totalMemory ? 0 : totalMemory - usedMemory;
+}
+
+
+// #################################################################################################
+// ###   MemoryManager: Memory blocks
+// #################################################################################################
+
+
+uint64_t MemoryManager::createBlock(uint32_t deviceIndex, uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated) {
+	VkDevice device = vkContext->getDevices()[deviceIndex];
+
+	// Define the memory allocation info
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkDeviceMemory memory;
+	if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate a memory block of " + std::to_string(size) + " bytes");
+	}
+
+	MemoryBlock block;
+	block.id = nextBlockId++;
+	block.memory = memory;
+	block.device = device;
+	block.size = size;
+	block.deviceIndex = deviceIndex;
+	block.memoryTypeIndex = memoryTypeIndex;
+	block.dedicated = dedicated;
+	block.freeRanges[0] = size;
+
+	memoryBlocks[block.id] = block;
+	return block.id;
+}
+
+
+void MemoryManager::destroyBlock(uint64_t blockId) {
+	auto it = memoryBlocks.find(blockId);
+	if (it == memoryBlocks.end()) {
+		return;
+	}
+	vkFreeMemory(it->second.device, it->second.memory, nullptr);
+	memoryBlocks.erase(it);
+}
+
+
+// Best-fit search of a free range satisfying the size and alignment requirements
+bool MemoryManager::placeInBlock(MemoryBlock& block, const VkMemoryRequirements& requirements, VkDeviceSize& offset) {
+	VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+	auto best = block.freeRanges.end();
+	VkDeviceSize bestOffset = 0;
+	for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+		VkDeviceSize alignedOffset = ((it->first + alignment - 1) / alignment) * alignment;
+		if (alignedOffset + requirements.size > it->first + it->second) {
+			continue;
+		}
+		if (best == block.freeRanges.end() || it->second < best->second) {
+			best = it;
+			bestOffset = alignedOffset;
+		}
+	}
+	if (best == block.freeRanges.end()) {
+		return false;
+	}
+
+	// Split the range: [padding][allocation][remainder]
+	VkDeviceSize rangeOffset = best->first;
+	VkDeviceSize rangeEnd = best->first + best->second;
+	block.freeRanges.erase(best);
+	if (bestOffset > rangeOffset) {
+		block.freeRanges[rangeOffset] = bestOffset - rangeOffset;
+	}
+	if (bestOffset + requirements.size < rangeEnd) {
+		block.freeRanges[bestOffset + requirements.size] = rangeEnd - bestOffset - requirements.size;
+	}
+
+	block.usedBytes += requirements.size;
+	block.allocationCount++;
+	offset = bestOffset;
+	return true;
+}
+
+
+void MemoryManager::freeRange(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
+	auto it = block.freeRanges.emplace(offset, size).first;
+
+	// Coalesce with the next range
+	auto next = std::next(it);
+	if (next != block.freeRanges.end() && it->first + it->second == next->first) {
+		it->second += next->second;
+		block.freeRanges.erase(next);
+	}
+	// Coalesce with the previous range
+	if (it != block.freeRanges.begin()) {
+		auto prev = std::prev(it);
+		if (prev->first + prev->second == it->first) {
+			prev->second += it->second;
+			block.freeRanges.erase(it);
+		}
+	}
+
+	block.usedBytes -= size;
+	block.allocationCount--;
+}
+
+
+VkDeviceSize MemoryManager::getFreeGapsSize(uint32_t deviceIndex) const {
+	VkDeviceSize gapsSize = 0;
+	for (const auto& kv : memoryBlocks) {
+		if (kv.second.deviceIndex == deviceIndex) {
+			gapsSize += kv.second.size - kv.second.usedBytes;
+		}
+	}
+	return gapsSize;
+}
+
+
+// #################################################################################################
+// ###   MemoryManager: Defragmentation
+// #################################################################################################
+
+
+FragmentationStats MemoryManager::getFragmentationStats(uint32_t deviceIndex) const {
+	std::lock_guard<std::recursive_mutex> lock(managerMutex);
+
+	FragmentationStats stats;
+	for (const auto& kv : memoryBlocks) {
+		const MemoryBlock& block = kv.second;
+		if (block.deviceIndex != deviceIndex) {
+			continue;
+		}
+		stats.blockCount++;
+		stats.reservedBytes += block.size;
+		stats.usedBytes += block.usedBytes;
+		for (const auto& range : block.freeRanges) {
+			stats.freeBytes += range.second;
+			stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+		}
+	}
+	return stats;
+}
+
+
+// Empties the least used shared blocks by moving their allocations into the free ranges of fuller blocks.
+// By default only the cached allocations move: blocks holding active allocations are left in place.
+// Cached buffers have undefined content once reused, so they are only rebound, the active ones are copied.
+// With includeActive, handles keep their id but the VkBuffer behind them changes: BufferInfo must be fetched again.
+// A block is only evacuated if all its allocations fit elsewhere, so each batch of copies releases one block.
+DefragmentationReport MemoryManager::defragment(uint32_t deviceIndex, std::chrono::microseconds timeBudget, bool includeActive) {
+	std::lock_guard<std::recursive_mutex> lock(managerMutex);
+
+	if (vkContext == nullptr) {
+		throw std::runtime_error("Memory Manager not initialized");
+	}
+	if (deviceIndex >= vkContext->getDeviceCount()) {
+		throw std::runtime_error("Unable to defragment an invalid device index");
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	DefragmentationReport report;
+	report.before = getFragmentationStats(deviceIndex);
+
+	// Shared blocks sorted from the least to the most used: sources first, destinations last
+	std::vector<uint64_t> blockIds;
+	for (const auto& kv : memoryBlocks) {
+		if (kv.second.deviceIndex == deviceIndex && !kv.second.dedicated) {
+			blockIds.push_back(kv.first);
+		}
+	}
+	std::sort(blockIds.begin(), blockIds.end(), [this](uint64_t a, uint64_t b) {
+		return memoryBlocks.at(a).usedBytes < memoryBlocks.at(b).usedBytes;
+	});
+
+	VkDevice device = vkContext->getDevices()[deviceIndex];
+	report.complete = true;
+
+	for (size_t i = 0; i < blockIds.size(); i++) {
+		// A slice releases at least one block, so that successive slices make progress whatever the budget
+		if (timeBudget.count() > 0 && report.releasedBlocks > 0 && std::chrono::steady_clock::now() - start >= timeBudget) {
+			report.complete = false;
+			break;
+		}
+		MemoryBlock& source = memoryBlocks.at(blockIds[i]);
+
+		// Collect the allocations living in the source block (skipped if an active one can't move), the active ones first
+		std::vector<AllocationInfo*> allocations;
+		bool movable = true;
+		for (auto& kv : activeAllocations) {
+			if (kv.second.blockId == source.id) {
+				movable = movable && includeActive;
+				allocations.push_back(&kv.second);
+			}
+		}
+		if (!movable) {
+			continue;
+		}
+		size_t activeCount = allocations.size();
+		for (auto& kv : cachedAllocations) {
+			if (kv.second.blockId == source.id) {
+				allocations.push_back(&kv.second);
+			}
+		}
+
+		// Plan the moves into the fuller blocks
+		struct Move {
+			AllocationInfo* alloc;
+			bool active;	// Cached buffers hold no data: they are only rebound, not copied
+			VkBuffer buffer;
+			uint64_t blockId;
+			VkDeviceSize offset;
+			VkDeviceSize reservedSize;
+		};
+		std::vector<Move> moves;
+		moves.reserve(allocations.size());
+
+		// Gives back the reserved ranges and destroys the new buffers, the allocations are left untouched
+		auto rollback = [&]() {
+			for (const Move& move : moves) {
+				if (move.blockId != 0) {
+					freeRange(memoryBlocks.at(move.blockId), move.offset, move.reservedSize);
+				}
+				vkDestroyBuffer(device, move.buffer, nullptr);
+			}
+		};
+
+		bool fits = true;
+		try {
+			for (size_t a = 0; a < allocations.size(); a++) {
+				AllocationInfo* alloc = allocations[a];
+				VkBuffer buffer = vkContext->createBuffer(device, alloc->size);
+				VkMemoryRequirements requirements;
+				vkGetBufferMemoryRequirements(device, buffer, &requirements);
+
+				moves.push_back({ alloc, a < activeCount, buffer, 0, 0, requirements.size });
+				Move& move = moves.back();
+				for (size_t j = i + 1; j < blockIds.size() && move.blockId == 0; j++) {
+					MemoryBlock& destination = memoryBlocks.at(blockIds[j]);
+					if (destination.memoryTypeIndex == source.memoryTypeIndex && (requirements.memoryTypeBits & (1u << destination.memoryTypeIndex)) &&
+						placeInBlock(destination, requirements, move.offset)) {
+						move.blockId = destination.id;
+					}
+				}
+
+				if (move.blockId == 0) {
+					fits = false;
+					break;
+				}
+			}
+		} catch (...) {
+			rollback();
+			throw;
+		}
+
+		// Roll back if the block can't be fully evacuated
+		if (!fits) {
+			rollback();
+			continue;
+		}
+
+		for (const Move& move : moves) {
+			if (vkBindBufferMemory(device, move.buffer, memoryBlocks.at(move.blockId).memory, move.offset) != VK_SUCCESS) {
+				rollback();
+				throw std::runtime_error("Failed to bind the buffer memory during the defragmentation");
+			}
+		}
+
+		// Copy the data of the active allocations on the GPU, after any previously submitted work
+		if (activeCount > 0) {
+			try {
+				vkContext->submitAndWait(deviceIndex, [&](VkCommandBuffer commandBuffer) {
+					VkMemoryBarrier barrier{};
+					barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+					barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+					vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+										 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+					for (const Move& move : moves) {
+						if (move.active) {
+							VkBufferCopy region{ 0, 0, move.alloc->size };
+							vkCmdCopyBuffer(commandBuffer, move.alloc->buffer, move.buffer, 1, &region);
+						}
+					}
+
+					// Make the copies visible to the following commands
+					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+					vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+										 0, 1, &barrier, 0, nullptr, 0, nullptr);
+				});
+			} catch (...) {
+				rollback();
+				throw;
+			}
+		}
+
+		// Update the handle -> buffer mapping
+		for (const Move& move : moves) {
+			vkDestroyBuffer(device, move.alloc->buffer, nullptr);
+			move.alloc->buffer = move.buffer;
+			move.alloc->blockId = move.blockId;
+			move.alloc->offset = move.offset;
+			move.alloc->reservedSize = move.reservedSize;
+
+			report.movedAllocations++;
+			report.movedBytes += move.alloc->size;
+		}
+
+		// The source block is now empty
+		destroyBlock(blockIds[i]);
+		report.releasedBlocks++;
+	}
+
+	report.after = getFragmentationStats(deviceIndex);
+	return report;
+}
+
+
+// #################################################################################################
+// ###   MemoryManager: Data transfers
+// #################################################################################################
+
+
+void MemoryManager::writeBuffer(const MemoryHandle& handle, const void* data, VkDeviceSize size, VkDeviceSize offset) {
+	std::unique_lock<std::recursive_mutex> lock(managerMutex);
+
+	// Check if the handle and range are valid
+	auto it = activeAllocations.find(handle.id);
+	if (it == activeAllocations.end()) {
+		throw std::runtime_error("Unable to write to an invalid buffer handle");
+	}
+	const AllocationInfo alloc = it->second;	// Copy: the map may change once the lock is released
+	if (offset + size > alloc.size) {
+		throw std::runtime_error("Unable to write outside of the buffer range");
+	}
+	if (size == 0) {
+		return;
+	}
+
+	// Fill a host-visible staging buffer
+	VkBuffer staging;
+	VkDeviceMemory stagingMemory;
+	vkContext->createBufferAndMemory(alloc.device, size, staging, stagingMemory,
+									 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	void* mapped = nullptr;
+	vkMapMemory(alloc.device, stagingMemory, 0, size, 0, &mapped);
+	std::memcpy(mapped, data, size);
+	vkUnmapMemory(alloc.device, stagingMemory);
+
+	// Copy to the device buffer (the lock is only needed until the copy is submitted)
+	try {
+		Submission submission = vkContext->submit(alloc.deviceIndex, [&](VkCommandBuffer commandBuffer) {
+			VkBufferCopy region{ 0, offset, size };
+			vkCmdCopyBuffer(commandBuffer, staging, alloc.buffer, 1, &region);
+
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+								 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		});
+		lock.unlock();
+		vkContext->wait(submission);
+	} catch (...) {
+		vkDestroyBuffer(alloc.device, staging, nullptr);
+		vkFreeMemory(alloc.device, stagingMemory, nullptr);
+		throw;
+	}
+
+	vkDestroyBuffer(alloc.device, staging, nullptr);
+	vkFreeMemory(alloc.device, stagingMemory, nullptr);
+}
+
+
+void MemoryManager::readBuffer(const MemoryHandle& handle, void* data, VkDeviceSize size, VkDeviceSize offset) {
+	std::unique_lock<std::recursive_mutex> lock(managerMutex);
+
+	// Check if the handle and range are valid
+	auto it = activeAllocations.find(handle.id);
+	if (it == activeAllocations.end()) {
+		throw std::runtime_error("Unable to read from an invalid buffer handle");
+	}
+	const AllocationInfo alloc = it->second;	// Copy: the map may change once the lock is released
+	if (offset + size > alloc.size) {
+		throw std::runtime_error("Unable to read outside of the buffer range");
+	}
+	if (size == 0) {
+		return;
+	}
+
+	VkBuffer staging;
+	VkDeviceMemory stagingMemory;
+	vkContext->createBufferAndMemory(alloc.device, size, staging, stagingMemory,
+									 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	// Copy from the device buffer, after any previously submitted work (the lock is only needed until the copy is submitted)
+	try {
+		Submission submission = vkContext->submit(alloc.deviceIndex, [&](VkCommandBuffer commandBuffer) {
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+								 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			VkBufferCopy region{ offset, 0, size };
+			vkCmdCopyBuffer(commandBuffer, alloc.buffer, staging, 1, &region);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+								 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		});
+		lock.unlock();
+		vkContext->wait(submission);
+	} catch (...) {
+		vkDestroyBuffer(alloc.device, staging, nullptr);
+		vkFreeMemory(alloc.device, stagingMemory, nullptr);
+		throw;
+	}
+
+	void* mapped = nullptr;
+	vkMapMemory(alloc.device, stagingMemory, 0, size, 0, &mapped);
+	std::memcpy(data, mapped, size);
+	vkUnmapMemory(alloc.device, stagingMemory);
+
+	vkDestroyBuffer(alloc.device, staging, nullptr);
+	vkFreeMemory(alloc.device, stagingMemory, nullptr);
+}
@@ -0,0 +1,268 @@
+#include "Primitives.hpp"
+#include "VulkanContext.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include <string>
+#include <utility>
+
+#define SUBGROUPS_PER_WORKGROUP 8
+#define MIN_WORKGROUP_SIZE 32			// At least RADIX_BUCKETS invocations
+#define MAX_WORKGROUP_SIZE 256
+#define ITEMS_PER_INVOCATION 4			// Must match primitives.glsl
+#define RADIX_BITS 4					// Must match radix_sort.comp (an even number of passes leaves the result in place)
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+
+
+
+// #################################################################################################
+// ###   Helpers
+// #################################################################################################
+
+
+// Temporary device buffers of a batch, released once it is done (or failed)
+struct ScratchBuffers {
+	std::vector<MemoryHandle> handles;
+
+	ScratchBuffers() = default;
+	ScratchBuffers(const ScratchBuffers&) = delete;
+	ScratchBuffers& operator=(const ScratchBuffers&) = delete;
+
+	// Also runs while a failed batch unwinds: a release error must not escape (std::terminate)
+	~ScratchBuffers() {
+		for (const MemoryHandle& handle : handles) {
+			try {
+				MemoryManager::getManager().releaseBuffer(handle);
+			} catch (...) {}
+		}
+	}
+
+	MemoryHandle get(VkDeviceSize size, uint32_t deviceIndex) {
+		handles.push_back(MemoryManager::getManager().getBuffer(size, deviceIndex));
+		return handles.back();
+	}
+};
+
+
+static void checkBufferSize(const MemoryHandle& handle, VkDeviceSize size, const std::string& name) {
+	VkDeviceSize available = MemoryManager::getManager().getBufferInfo(handle).size;
+	if (available < size) {
+		throw std::runtime_error("Buffer " + name + " of " + std::to_string(available) + " bytes is too small, " +
+								 std::to_string(size) + " bytes required");
+	}
+}
+
+
+// Launch of a primitives kernel, specialized for the workgroup size of the device
+template <typename Params>
+static KernelLaunch makeLaunch(const std::string& kernelName, std::vector<MemoryHandle> buffers, uint32_t workgroupSize,
+							   const Params& params, uint32_t groupCount) {
+	KernelLaunch launch;
+	launch.kernelName = kernelName;
+	launch.buffers = std::move(buffers);
+	launch.specializationConstants = { workgroupSize, workgroupSize * ITEMS_PER_INVOCATION };
+	launch.setPushConstants(params);
+	launch.groupCount[0] = groupCount;
+	return launch;
+}
+
+
+struct ScanParams {
+	uint32_t count;
+	uint32_t pass;		// 0: tile sums, 1: tile prefix sums
+	uint32_t inclusive;
+	uint32_t hasOffsets;
+};
+
+
+struct RadixSortParams {
+	uint32_t count;
+	uint32_t shift;
+	uint32_t pass;		// 0: tile histograms, 1: scatter
+	uint32_t hasPayloads;
+};
+
+
+struct RadixFlipParams {
+	uint32_t count;
+	uint32_t inverse;
+};
+
+
+struct CompactParams {
+	uint32_t count;
+	uint32_t pass;		// 0: flags to 0 / 1, 1: scatter
+};
+
+
+// #################################################################################################
+// ###   Primitives: Configuration
+// #################################################################################################
+
+
+uint32_t Primitives::getWorkgroupSize(uint32_t deviceIndex) {
+	auto& context = VulkanContext::getContext();
+	if (deviceIndex >= context.getDeviceCount()) {
+		throw std::runtime_error("Invalid device index " + std::to_string(deviceIndex));
+	}
+	const DeviceLimits& limits = context.getDeviceLimits()[deviceIndex];
+
+	// A few subgroups per workgroup: enough invocations to hide latency, short barrier-bound scans
+	uint32_t size = std::clamp<uint32_t>(limits.subgroupSize * SUBGROUPS_PER_WORKGROUP, MIN_WORKGROUP_SIZE,
+										 std::max<uint32_t>(std::min<uint32_t>(MAX_WORKGROUP_SIZE, limits.maxWorkgroupSize), MIN_WORKGROUP_SIZE));
+	size = std::bit_floor(size);
+
+	// The radix sort keeps a tile of 64-bit keys and payloads in shared memory
+	auto sharedMemory = [](uint32_t workgroupSize) {
+		return workgroupSize * ITEMS_PER_INVOCATION * (sizeof(uint64_t) + sizeof(uint32_t)) + workgroupSize * sizeof(uint32_t) +
+			   2 * RADIX_BUCKETS * sizeof(uint32_t);
+	};
+	while (size > MIN_WORKGROUP_SIZE && sharedMemory(size) > limits.maxSharedMemorySize) {
+		size /= 2;
+	}
+	return size;
+}
+
+
+// #################################################################################################
+// ###   Primitives: Scan
+// #################################################################################################
+
+
+void Primitives::exclusiveScan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count) {
+	scan(deviceIndex, input, output, count, false);
+}
+
+
+void Primitives::inclusiveScan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count) {
+	scan(deviceIndex, input, output, count, true);
+}
+
+
+void Primitives::scan(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& output, uint32_t count, bool inclusive) {
+	if (count == 0) {
+		return;
+	}
+	checkBufferSize(input, count * sizeof(uint32_t), "input");
+	checkBufferSize(output, count * sizeof(uint32_t), "output");
+
+	ScratchBuffers scratch;
+	std::vector<KernelLaunch> launches;
+	appendScan(launches, scratch.handles, deviceIndex, input, output, count, inclusive);
+	KernelManager::getManager().dispatchBatch(deviceIndex, launches);
+}
+
+
+void Primitives::appendScan(std::vector<KernelLaunch>& launches, std::vector<MemoryHandle>& scratch, uint32_t deviceIndex,
+							const MemoryHandle& input, const MemoryHandle& output, uint32_t count, bool inclusive) {
+	uint32_t workgroupSize = getWorkgroupSize(deviceIndex);
+	uint32_t tileSize = workgroupSize * ITEMS_PER_INVOCATION;
+
+	// A single tile is scanned directly (the partials binding is unused)
+	if (count <= tileSize) {
+		launches.push_back(makeLaunch("scan", { input, output, input }, workgroupSize,
+									  ScanParams{ count, 1, inclusive, 0 }, 1));
+		return;
+	}
+
+	// Reduce the tiles, scan the tile sums, then scan the tiles from their offsets
+	uint32_t tileCount = (count + tileSize - 1) / tileSize;
+	scratch.push_back(MemoryManager::getManager().getBuffer(tileCount * sizeof(uint32_t), deviceIndex));
+	MemoryHandle partials = scratch.back();
+	uint32_t groupCount = KernelManager::getGroupCount(count, tileSize);
+
+	launches.push_back(makeLaunch("scan", { input, output, partials }, workgroupSize,
+								  ScanParams{ count, 0, inclusive, 0 }, groupCount));
+	appendScan(launches, scratch, deviceIndex, partials, partials, tileCount, false);
+	launches.push_back(makeLaunch("scan", { input, output, partials }, workgroupSize,
+								  ScanParams{ count, 1, inclusive, 1 }, groupCount));
+}
+
+
+// #################################################################################################
+// ###   Primitives: Radix sort
+// #################################################################################################
+
+
+void Primitives::radixSort(uint32_t deviceIndex, const MemoryHandle& keys, const MemoryHandle& payloads, uint32_t count,
+						   SortKeyType keyType) {
+	if (count == 0) {
+		return;
+	}
+	bool wideKeys = keyType == SortKeyType::Uint64;
+	VkDeviceSize keySize = wideKeys ? sizeof(uint64_t) : sizeof(uint32_t);
+	uint32_t keyBits = static_cast<uint32_t>(keySize * 8);
+	bool hasPayloads = payloads.id != 0;
+
+	checkBufferSize(keys, count * keySize, "keys");
+	if (hasPayloads) {
+		checkBufferSize(payloads, count * sizeof(uint32_t), "payloads");
+	}
+
+	uint32_t workgroupSize = getWorkgroupSize(deviceIndex);
+	uint32_t tileSize = workgroupSize * ITEMS_PER_INVOCATION;
+	uint32_t tileCount = (count + tileSize - 1) / tileSize;
+	uint32_t groupCount = KernelManager::getGroupCount(count, tileSize);
+
+	// Ping-pong between the caller's buffers and temporary ones (unused payload bindings alias the keys)
+	ScratchBuffers scratch;
+	MemoryHandle histograms = scratch.get(RADIX_BUCKETS * tileCount * sizeof(uint32_t), deviceIndex);
+	MemoryHandle tempKeys = scratch.get(count * keySize, deviceIndex);
+	MemoryHandle tempPayloads = hasPayloads ? scratch.get(count * sizeof(uint32_t), deviceIndex) : tempKeys;
+
+	std::pair<MemoryHandle, MemoryHandle> source = { keys, hasPayloads ? payloads : keys };
+	std::pair<MemoryHandle, MemoryHandle> destination = { tempKeys, tempPayloads };
+
+	std::vector<KernelLaunch> launches;
+	uint32_t flipGroupCount = KernelManager::getGroupCount(count, workgroupSize);
+	if (keyType == SortKeyType::Float32) {
+		launches.push_back(makeLaunch("radix_flip", { keys }, workgroupSize, RadixFlipParams{ count, 0 }, flipGroupCount));
+	}
+
+	std::string kernelName = wideKeys ? "radix_sort_u64" : "radix_sort_u32";
+	for (uint32_t shift = 0; shift < keyBits; shift += RADIX_BITS) {
+		std::vector<MemoryHandle> buffers = { source.first, source.second, destination.first, destination.second, histograms };
+		launches.push_back(makeLaunch(kernelName, buffers, workgroupSize, RadixSortParams{ count, shift, 0, hasPayloads }, groupCount));
+		appendScan(launches, scratch.handles, deviceIndex, histograms, histograms, RADIX_BUCKETS * tileCount, false);
+		launches.push_back(makeLaunch(kernelName, buffers, workgroupSize, RadixSortParams{ count, shift, 1, hasPayloads }, groupCount));
+		std::swap(source, destination);
+	}
+
+	if (keyType == SortKeyType::Float32) {
+		launches.push_back(makeLaunch("radix_flip", { keys }, workgroupSize, RadixFlipParams{ count, 1 }, flipGroupCount));
+	}
+	KernelManager::getManager().dispatchBatch(deviceIndex, launches);
+}
+
+
+// #################################################################################################
+// ###   Primitives: Compaction
+// #################################################################################################
+
+
+void Primitives::compact(uint32_t deviceIndex, const MemoryHandle& input, const MemoryHandle& flags, const MemoryHandle& output,
+						 const MemoryHandle& outputCount, uint32_t count) {
+	checkBufferSize(outputCount, sizeof(uint32_t), "outputCount");
+	if (count == 0) {
+		uint32_t zero = 0;
+		MemoryManager::getManager().writeBuffer(outputCount, &zero, sizeof(zero));
+		return;
+	}
+	checkBufferSize(input, count * sizeof(uint32_t), "input");
+	checkBufferSize(flags, count * sizeof(uint32_t), "flags");
+	checkBufferSize(output, count * sizeof(uint32_t), "output");
+
+	uint32_t workgroupSize = getWorkgroupSize(deviceIndex);
+	uint32_t groupCount = KernelManager::getGroupCount(count, workgroupSize);
+
+	ScratchBuffers scratch;
+	MemoryHandle offsets = scratch.get(count * sizeof(uint32_t), deviceIndex);
+	std::vector<MemoryHandle> buffers = { input, flags, offsets, output, outputCount };
+
+	std::vector<KernelLaunch> launches;
+	launches.push_back(makeLaunch("compact", buffers, workgroupSize, CompactParams{ count, 0 }, groupCount));
+	appendScan(launches, scratch.handles, deviceIndex, offsets, offsets, count, false);
+	launches.push_back(makeLaunch("compact", buffers, workgroupSize, CompactParams{ count, 1 }, groupCount));
+	KernelManager::getManager().dispatchBatch(deviceIndex, launches);
+}
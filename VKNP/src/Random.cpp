@@ -0,0 +1,105 @@
+#include "Random.hpp"
+
+#include <cmath>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u	// Golden ratio
+#define PHILOX_W1 0xBB67AE85u	// sqrt(3) - 1
+#define PHILOX_ROUNDS 10
+
+#define UNIT_SCALE (1.0f / 16777216.0f)	// 24-bit integers -> [0, 1), exact in float32
+#define TWO_PI 6.28318530717958647692f
+
+
+
+// #################################################################################################
+// ###   RandomSpec
+// #################################################################################################
+
+
+RandomSpec RandomSpec::uniform(float low, float high, uint64_t seed, uint64_t offset) {
+	return { Distribution::Uniform, low, high, seed, offset };
+}
+
+
+RandomSpec RandomSpec::normal(float mean, float stddev, uint64_t seed, uint64_t offset) {
+	return { Distribution::Normal, mean, stddev, seed, offset };
+}
+
+
+RandomSpec RandomSpec::bernoulli(float probability, uint64_t seed, uint64_t offset) {
+	return { Distribution::Bernoulli, probability, 0.0f, seed, offset };
+}
+
+
+// #################################################################################################
+// ###   Philox4x32-10 (must match shaders/philox.glsl)
+// #################################################################################################
+
+
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key) {
+	for (int round = 0; round < PHILOX_ROUNDS; round++) {
+		uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * counter[0];
+		uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * counter[2];
+
+		counter = {
+			static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+			static_cast<uint32_t>(product1),
+			static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+			static_cast<uint32_t>(product0),
+		};
+		key[0] += PHILOX_W0;
+		key[1] += PHILOX_W1;
+	}
+	return counter;
+}
+
+
+// The 4 values of a block, the Box-Muller pairs are (0, 1) and (2, 3)
+static std::array<float, 4> toDistribution(const std::array<uint32_t, 4>& bits, const RandomSpec& spec) {
+	std::array<float, 4> values;
+	switch (spec.distribution) {
+		case Distribution::Uniform:
+			for (int lane = 0; lane < 4; lane++) {
+				float unit = static_cast<float>(bits[lane] >> 8) * UNIT_SCALE;
+				values[lane] = spec.a + (spec.b - spec.a) * unit;
+			}
+			break;
+
+		case Distribution::Normal:
+			for (int pair = 0; pair < 4; pair += 2) {
+				float u1 = static_cast<float>((bits[pair] >> 8) + 1) * UNIT_SCALE;	// (0, 1]: log(u1) is finite
+				float u2 = static_cast<float>(bits[pair + 1] >> 8) * UNIT_SCALE;
+				float radius = std::sqrt(-2.0f * std::log(u1));
+				values[pair] = spec.a + spec.b * (radius * std::cos(TWO_PI * u2));
+				values[pair + 1] = spec.a + spec.b * (radius * std::sin(TWO_PI * u2));
+			}
+			break;
+
+		case Distribution::Bernoulli:
+			for (int lane = 0; lane < 4; lane++) {
+				float unit = static_cast<float>(bits[lane] >> 8) * UNIT_SCALE;
+				values[lane] = unit < spec.a ? 1.0f : 0.0f;
+			}
+			break;
+	}
+	return values;
+}
+
+
+void generateRandom(const RandomSpec& spec, uint64_t first, float* values, size_t count) {
+	std::array<uint32_t, 2> key = { static_cast<uint32_t>(spec.seed), static_cast<uint32_t>(spec.seed >> 32) };
+	uint64_t index = spec.offset + first;
+
+	size_t i = 0;
+	while (i < count) {
+		// Element index -> (block, lane)
+		uint64_t block = index / 4;
+		std::array<float, 4> blockValues = toDistribution(philox4x32({ static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32), 0, 0 }, key), spec);
+
+		for (uint64_t lane = index % 4; lane < 4 && i < count; lane++, i++, index++) {
+			values[i] = blockValues[lane];
+		}
+	}
+}
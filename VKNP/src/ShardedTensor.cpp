@@ -0,0 +1,248 @@
+#include "ShardedTensor.hpp"
+#include "VulkanContext.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <numeric>
+#include <string>
+
+
+
+// #################################################################################################
+// ###   Helpers
+// #################################################################################################
+
+
+// Row-major tensor seen as [outer, axis, inner], inner counted in bytes
+struct AxisExtents {
+	size_t outer = 1;
+	size_t axisSize = 0;
+	size_t innerBytes = 0;
+};
+
+
+static AxisExtents getAxisExtents(const std::vector<size_t>& shape, size_t axis, DType dtype) {
+	AxisExtents extents;
+	extents.axisSize = shape[axis];
+	extents.innerBytes = getDTypeSize(dtype);
+	for (size_t i = 0; i < shape.size(); i++) {
+		if (i < axis) {
+			extents.outer *= shape[i];
+		} else if (i > axis) {
+			extents.innerBytes *= shape[i];
+		}
+	}
+	return extents;
+}
+
+
+// Copy the slice [start, start + length) of the axis between the full tensor and the slice tensor
+static void copySlice(std::byte* full, std::byte* slice, const AxisExtents& extents, size_t start, size_t length, bool toSlice) {
+	size_t sliceBytes = length * extents.innerBytes;
+	for (size_t o = 0; o < extents.outer; o++) {
+		std::byte* fullPtr = full + (o * extents.axisSize + start) * extents.innerBytes;
+		std::byte* slicePtr = slice + o * sliceBytes;
+		if (toSlice) {
+			std::memcpy(slicePtr, fullPtr, sliceBytes);
+		} else {
+			std::memcpy(fullPtr, slicePtr, sliceBytes);
+		}
+	}
+}
+
+
+static std::vector<uint32_t> resolveDevices(const std::vector<uint32_t>& deviceIndices) {
+	if (!deviceIndices.empty()) {
+		return deviceIndices;
+	}
+	std::vector<uint32_t> devices(VulkanContext::getContext().getDeviceCount());
+	std::iota(devices.begin(), devices.end(), 0);
+	return devices;
+}
+
+
+void runOnShards(size_t shardCount, const std::function<void(size_t)>& task) {
+	if (shardCount == 1) {
+		task(0);
+		return;
+	}
+
+	std::vector<std::future<void>> futures;
+	for (size_t i = 0; i < shardCount; i++) {
+		futures.push_back(std::async(std::launch::async, task, i));
+	}
+
+	std::exception_ptr error;
+	for (auto& future : futures) {
+		try {
+			future.get();
+		} catch (...) {
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+
+// #################################################################################################
+// ###   ShardedTensor: Factories
+// #################################################################################################
+
+
+ShardedTensor ShardedTensor::split(const Tensor& tensor, size_t axis, const std::vector<uint32_t>& deviceIndices) {
+	const std::vector<size_t>& shape = tensor.getShape();
+	if (axis >= shape.size()) {
+		throw std::runtime_error("Unable to split a tensor of rank " + std::to_string(shape.size()) + " along axis " + std::to_string(axis));
+	}
+	std::vector<uint32_t> devices = resolveDevices(deviceIndices);
+
+	// No empty shards: short axes use fewer devices
+	AxisExtents extents = getAxisExtents(shape, axis, tensor.getDType());
+	size_t shardCount = std::clamp<size_t>(extents.axisSize, 1, devices.size());
+
+	Tensor host = tensor.to(TensorLocation::Host);
+	std::byte* full = static_cast<std::byte*>(host.getHostData());
+
+	std::vector<Tensor> shards(shardCount);
+	runOnShards(shardCount, [&](size_t i) {
+		size_t start = i * extents.axisSize / shardCount;
+		size_t end = (i + 1) * extents.axisSize / shardCount;
+
+		std::vector<size_t> shardShape = shape;
+		shardShape[axis] = end - start;
+		Tensor slice = Tensor::empty(shardShape, TensorLocation::Host, 0, tensor.getDType());
+		copySlice(full, static_cast<std::byte*>(slice.getHostData()), extents, start, end - start, true);
+
+		shards[i] = slice.to(TensorLocation::Device, devices[i]);
+	});
+	return fromShards(std::move(shards), ShardLayout::Split, axis);
+}
+
+
+ShardedTensor ShardedTensor::replicate(const Tensor& tensor, const std::vector<uint32_t>& deviceIndices) {
+	std::vector<uint32_t> devices = resolveDevices(deviceIndices);
+
+	// Download once, then upload to every device
+	Tensor host = tensor.to(TensorLocation::Host);
+
+	std::vector<Tensor> shards(devices.size());
+	runOnShards(devices.size(), [&](size_t i) {
+		shards[i] = host.to(TensorLocation::Device, devices[i]);
+	});
+	return fromShards(std::move(shards), ShardLayout::Replicated);
+}
+
+
+ShardedTensor ShardedTensor::fromShards(std::vector<Tensor> shards, ShardLayout layout, size_t axis) {
+	if (shards.empty()) {
+		throw std::runtime_error("A sharded tensor needs at least one shard");
+	}
+	const Tensor& first = shards[0];
+	if (layout == ShardLayout::Split && axis >= first.getShape().size()) {
+		throw std::runtime_error("Invalid shard axis " + std::to_string(axis));
+	}
+
+	ShardedTensor result;
+	result.shape = first.getShape();
+	result.layout = layout;
+	result.axis = layout == ShardLayout::Split ? axis : 0;
+	if (layout == ShardLayout::Split) {
+		result.shape[axis] = 0;
+	}
+
+	for (const Tensor& shard : shards) {
+		if (shard.isHost()) {
+			throw std::runtime_error("Shards must be device tensors");
+		}
+		if (shard.getDType() != first.getDType()) {
+			throw std::runtime_error("Shards of different dtypes");
+		}
+
+		// Replicas and partial results have the whole shape, slices only differ along the axis
+		std::vector<size_t> expected = result.shape;
+		if (layout == ShardLayout::Split) {
+			if (shard.getShape().size() != expected.size()) {
+				throw std::runtime_error("Shards of different ranks");
+			}
+			expected[axis] = shard.getShape()[axis];
+			result.shape[axis] += shard.getShape()[axis];
+		}
+		if (shard.getShape() != expected) {
+			throw std::runtime_error("Shard shapes don't match the layout");
+		}
+	}
+
+	result.shards = std::move(shards);
+	return result;
+}
+
+
+// #################################################################################################
+// ###   ShardedTensor: Gather and getters
+// #################################################################################################
+
+
+Tensor ShardedTensor::gather(TensorLocation location, uint32_t deviceIndex) const {
+	if (shards.empty()) {
+		throw std::runtime_error("Unable to gather an empty sharded tensor");
+	}
+
+	switch (layout) {
+		case ShardLayout::Replicated:
+			return shards[0].to(location, deviceIndex);
+
+		case ShardLayout::Partial:
+			throw std::runtime_error("Partial results must be reduced before being gathered");
+
+		case ShardLayout::Split:
+			break;
+	}
+
+	// Download the slices concurrently, then concatenate them on the host
+	AxisExtents extents = getAxisExtents(shape, axis, getDType());
+	Tensor full = Tensor::empty(shape, TensorLocation::Host, 0, getDType());
+	std::byte* fullData = static_cast<std::byte*>(full.getHostData());
+
+	std::vector<size_t> starts(shards.size(), 0);
+	for (size_t i = 1; i < shards.size(); i++) {
+		starts[i] = starts[i - 1] + shards[i - 1].getShape()[axis];
+	}
+
+	runOnShards(shards.size(), [&](size_t i) {
+		Tensor slice = shards[i].to(TensorLocation::Host);
+		copySlice(fullData, static_cast<std::byte*>(slice.getHostData()), extents, starts[i], shards[i].getShape()[axis], false);
+	});
+	return full.to(location, deviceIndex);
+}
+
+
+bool ShardedTensor::isAlignedWith(const ShardedTensor& other) const {
+	if (layout != other.layout || shards.size() != other.shards.size() || shape != other.shape) {
+		return false;
+	}
+	if (layout == ShardLayout::Split && axis != other.axis) {
+		return false;
+	}
+	for (size_t i = 0; i < shards.size(); i++) {
+		if (shards[i].getShape() != other.shards[i].getShape() || shards[i].getDeviceIndex() != other.shards[i].getDeviceIndex()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+std::vector<uint32_t> ShardedTensor::getDeviceIndices() const {
+	std::vector<uint32_t> devices;
+	for (const Tensor& shard : shards) {
+		devices.push_back(shard.getDeviceIndex());
+	}
+	return devices;
+}
@@ -0,0 +1,168 @@
+#include "Tensor.hpp"
+#include "MemoryManager.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+
+
+
+// #################################################################################################
+// ###   Tensor: Lifetime
+// #################################################################################################
+
+
+Tensor::~Tensor() {
+	release();
+}
+
+
+Tensor::Tensor(const Tensor& other)
+	: shape(other.shape), dtype(other.dtype), location(other.location), deviceIndex(other.deviceIndex),
+	  handle(other.handle), hostStorage(other.hostStorage) {
+	// New view on the same buffer
+	if (handle.id != 0) {
+		MemoryManager::getManager().acquireBuffer(handle);
+	}
+}
+
+
+Tensor::Tensor(Tensor&& other) noexcept
+	: shape(std::move(other.shape)), dtype(other.dtype), location(other.location), deviceIndex(other.deviceIndex),
+	  handle(other.handle), hostStorage(std::move(other.hostStorage)) {
+	other.handle.id = 0;
+}
+
+
+Tensor& Tensor::operator=(const Tensor& other) {
+	if (this != &other) {
+		Tensor copy(other);
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+
+Tensor& Tensor::operator=(Tensor&& other) noexcept {
+	if (this != &other) {
+		release();
+		shape = std::move(other.shape);
+		dtype = other.dtype;
+		location = other.location;
+		deviceIndex = other.deviceIndex;
+		handle = other.handle;
+		hostStorage = std::move(other.hostStorage);
+		other.handle.id = 0;
+	}
+	return *this;
+}
+
+
+void Tensor::release() {
+	if (handle.id != 0) {
+		// The manager may already be destroyed when the application shuts down
+		try {
+			MemoryManager::getManager().releaseBuffer(handle);
+		} catch (const std::runtime_error&) {}
+		handle.id = 0;
+	}
+	hostStorage.reset();
+}
+
+
+// #################################################################################################
+// ###   Tensor: Factories and transfers
+// #################################################################################################
+
+
+Tensor Tensor::empty(const std::vector<size_t>& shape, TensorLocation location, uint32_t deviceIndex, DType dtype) {
+	Tensor tensor;
+	tensor.shape = shape;
+	tensor.dtype = dtype;
+	tensor.location = location;
+	tensor.deviceIndex = deviceIndex;
+
+	if (location == TensorLocation::Host) {
+		tensor.hostStorage = std::make_shared<std::vector<std::byte>>(tensor.getByteSize());
+	} else {
+		// Vulkan doesn't allow empty buffers
+		VkDeviceSize size = std::max<VkDeviceSize>(tensor.getByteSize(), 4);
+		tensor.handle = MemoryManager::getManager().getBuffer(size, deviceIndex);
+	}
+	return tensor;
+}
+
+
+Tensor Tensor::fromVector(const std::vector<float>& values, const std::vector<size_t>& shape, TensorLocation location,
+						  uint32_t deviceIndex, DType dtype) {
+	Tensor tensor = empty(shape, TensorLocation::Host, 0, dtype);
+	if (values.size() != tensor.getElementCount()) {
+		throw std::runtime_error("Unable to create a tensor of " + std::to_string(tensor.getElementCount()) +
+								 " elements from " + std::to_string(values.size()) + " values");
+	}
+	convertFromFloat(dtype, values.data(), tensor.getHostData(), values.size());
+	return tensor.to(location, deviceIndex);
+}
+
+
+Tensor Tensor::to(TensorLocation target, uint32_t targetDeviceIndex) const {
+	if (target == location && (target == TensorLocation::Host || targetDeviceIndex == deviceIndex)) {
+		return *this;
+	}
+
+	auto& memMgr = MemoryManager::getManager();
+	Tensor result = empty(shape, target, targetDeviceIndex, dtype);
+
+	if (location == TensorLocation::Host) {
+		// Host -> Device
+		memMgr.writeBuffer(result.handle, getHostData(), getByteSize());
+	} else if (target == TensorLocation::Host) {
+		// Device -> Host
+		memMgr.readBuffer(handle, result.getHostData(), getByteSize());
+	} else {
+		// Device -> Device, staged through the host
+		std::vector<std::byte> staging(getByteSize());
+		memMgr.readBuffer(handle, staging.data(), staging.size());
+		memMgr.writeBuffer(result.handle, staging.data(), staging.size());
+	}
+	return result;
+}
+
+
+std::vector<float> Tensor::toVector() const {
+	Tensor host = to(TensorLocation::Host);
+
+	std::vector<float> values(getElementCount());
+	convertToFloat(dtype, host.getHostData(), values.data(), values.size());
+	return values;
+}
+
+
+// #################################################################################################
+// ###   Tensor: Getters
+// #################################################################################################
+
+
+size_t Tensor::getElementCount() const {
+	size_t count = 1;
+	for (size_t dim : shape) {
+		count *= dim;
+	}
+	return count;
+}
+
+
+void* Tensor::getHostData() {
+	if (location != TensorLocation::Host) {
+		throw std::runtime_error("Unable to access the host data of a device tensor");
+	}
+	return hostStorage->data();
+}
+
+
+const void* Tensor::getHostData() const {
+	if (location != TensorLocation::Host) {
+		throw std::runtime_error("Unable to access the host data of a device tensor");
+	}
+	return hostStorage->data();
+}
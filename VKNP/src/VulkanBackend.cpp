@@ -0,0 +1,159 @@
+#include "VulkanBackend.hpp"
+#include "KernelManager.hpp"
+#include "Broadcast.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#define ELEMENTWISE_WORKGROUP_SIZE 256
+#define MATMUL_TILE_SIZE 16
+
+
+
+// Push constants of the strided binary kernels
+struct StridedBinaryParams {
+	uint32_t count;
+	uint32_t op;
+	uint32_t rank;
+	uint32_t shape[MAX_BROADCAST_RANK];
+	uint32_t stridesA[MAX_BROADCAST_RANK];
+	uint32_t stridesB[MAX_BROADCAST_RANK];
+};
+
+
+// Operands are read in place with broadcasting, the float32 kernels use vec4 accesses when the layout allows it
+void VulkanBackend::binary(BinaryOp op, const Tensor& a, const Tensor& b, Tensor& out) {
+	BroadcastLayout layout = BroadcastLayout::create(a.getShape(), b.getShape(), out.getShape());
+	uint32_t count = static_cast<uint32_t>(out.getElementCount());
+	bool isFloat32 = out.getDType() == DType::Float32;
+	auto& kernelManager = KernelManager::getManager();
+
+	// Contiguous fast path: no index computations
+	if (layout.isContiguous()) {
+		bool vectorized = isFloat32 && count % 4 == 0;
+		struct {
+			uint32_t count;
+			uint32_t op;
+		} params{ vectorized ? count / 4 : count, static_cast<uint32_t>(op) };
+
+		std::string kernelName = vectorized ? "elementwise_binary_vec4_f32" : std::string("elementwise_binary_") + getDTypeSuffix(out.getDType());
+		kernelManager.dispatch(out.getDeviceIndex(), kernelName, { a.getHandle(), b.getHandle(), out.getHandle() }, &params, sizeof(params),
+							   KernelManager::getGroupCount(params.count, ELEMENTWISE_WORKGROUP_SIZE));
+		return;
+	}
+
+	if (layout.getRank() > MAX_BROADCAST_RANK) {
+		throw std::runtime_error("Broadcast layout of rank " + std::to_string(layout.getRank()) + " exceeds the " +
+								 std::to_string(MAX_BROADCAST_RANK) + " dimensions of the strided kernels");
+	}
+
+	// vec4 accesses need groups of 4 outputs along the innermost dimension, read with a unit or zero stride
+	size_t inner = layout.getRank() - 1;
+	bool vectorized = isFloat32 && layout.getInnerSize() % 4 == 0 && layout.stridesA[inner] <= 1 && layout.stridesB[inner] <= 1;
+
+	StridedBinaryParams params{};
+	params.count = vectorized ? count / 4 : count;
+	params.op = static_cast<uint32_t>(op);
+	params.rank = static_cast<uint32_t>(layout.getRank());
+	for (size_t d = 0; d < layout.getRank(); d++) {
+		params.shape[d] = static_cast<uint32_t>(layout.shape[d]);
+		params.stridesA[d] = static_cast<uint32_t>(layout.stridesA[d]);
+		params.stridesB[d] = static_cast<uint32_t>(layout.stridesB[d]);
+	}
+
+	std::vector<MemoryHandle> buffers = { a.getHandle(), b.getHandle(), out.getHandle() };
+	std::string kernelName = std::string("elementwise_binary_strided_") + getDTypeSuffix(out.getDType());
+	if (vectorized) {
+		buffers.push_back(a.getHandle());	// Scalar views of the broadcast operands
+		buffers.push_back(b.getHandle());
+		kernelName = "elementwise_binary_strided_vec4_f32";
+	}
+	kernelManager.dispatch(out.getDeviceIndex(), kernelName, buffers, &params, sizeof(params),
+						   KernelManager::getGroupCount(params.count, ELEMENTWISE_WORKGROUP_SIZE));
+}
+
+
+void VulkanBackend::unary(UnaryOp op, const Tensor& a, Tensor& out, float alpha) {
+	struct {
+		uint32_t count;
+		uint32_t op;
+		float alpha;
+	} params{ static_cast<uint32_t>(out.getElementCount()), static_cast<uint32_t>(op), alpha };
+
+	KernelManager::getManager().dispatch(out.getDeviceIndex(), std::string("elementwise_unary_") + getDTypeSuffix(out.getDType()),
+										 { a.getHandle(), out.getHandle() }, &params, sizeof(params),
+										 KernelManager::getGroupCount(params.count, ELEMENTWISE_WORKGROUP_SIZE));
+}
+
+
+void VulkanBackend::matmul(const Tensor& a, const Tensor& b, Tensor& out) {
+	struct {
+		uint32_t M;
+		uint32_t N;
+		uint32_t K;
+	} params{ static_cast<uint32_t>(a.getShape()[0]), static_cast<uint32_t>(b.getShape()[1]), static_cast<uint32_t>(a.getShape()[1]) };
+
+	KernelManager::getManager().dispatch(out.getDeviceIndex(), std::string("matmul_") + getDTypeSuffix(out.getDType()),
+										 { a.getHandle(), b.getHandle(), out.getHandle() }, &params, sizeof(params),
+										 (params.N + MATMUL_TILE_SIZE - 1) / MATMUL_TILE_SIZE,
+										 (params.M + MATMUL_TILE_SIZE - 1) / MATMUL_TILE_SIZE);
+}
+
+
+void VulkanBackend::convert(const Tensor& a, Tensor& out) {
+	struct {
+		uint32_t count;
+	} params{ static_cast<uint32_t>(out.getElementCount()) };
+
+	std::string kernelName = std::string("convert_") + getDTypeSuffix(a.getDType()) + "_" + getDTypeSuffix(out.getDType());
+	KernelManager::getManager().dispatch(out.getDeviceIndex(), kernelName,
+										 { a.getHandle(), out.getHandle() }, &params, sizeof(params),
+										 KernelManager::getGroupCount(params.count, ELEMENTWISE_WORKGROUP_SIZE));
+}
+
+
+// Push constants of the random kernels
+struct RandomParams {
+	uint32_t count;
+	uint32_t distribution;
+	float a;
+	float b;
+	uint32_t seed[2];		// (low, high)
+	uint32_t offset[2];
+	uint32_t op;
+	float alpha;
+};
+
+
+static RandomParams getRandomParams(const RandomSpec& spec, size_t count, BinaryOp op, float alpha) {
+	return {
+		static_cast<uint32_t>(count), static_cast<uint32_t>(spec.distribution), spec.a, spec.b,
+		{ static_cast<uint32_t>(spec.seed), static_cast<uint32_t>(spec.seed >> 32) },
+		{ static_cast<uint32_t>(spec.offset), static_cast<uint32_t>(spec.offset >> 32) },
+		static_cast<uint32_t>(op), alpha
+	};
+}
+
+
+// One invocation per block of 4 values
+static uint32_t getRandomGroupCount(const RandomSpec& spec, size_t count) {
+	return KernelManager::getGroupCount((count + spec.offset % 4 + 3) / 4, ELEMENTWISE_WORKGROUP_SIZE);
+}
+
+
+void VulkanBackend::random(const RandomSpec& spec, Tensor& out) {
+	RandomParams params = getRandomParams(spec, out.getElementCount(), BinaryOp::Add, 1.0f);
+
+	KernelManager::getManager().dispatch(out.getDeviceIndex(), std::string("random_") + getDTypeSuffix(out.getDType()),
+										 { out.getHandle() }, &params, sizeof(params),
+										 getRandomGroupCount(spec, params.count));
+}
+
+
+void VulkanBackend::randomBinary(BinaryOp op, const Tensor& a, const RandomSpec& spec, float alpha, Tensor& out) {
+	RandomParams params = getRandomParams(spec, out.getElementCount(), op, alpha);
+
+	KernelManager::getManager().dispatch(out.getDeviceIndex(), std::string("random_fused_") + getDTypeSuffix(out.getDType()),
+										 { a.getHandle(), out.getHandle() }, &params, sizeof(params),
+										 getRandomGroupCount(spec, params.count));
+}
@@ -1,5 +1,7 @@
 #include "VulkanContext.hpp"
 
+#include <algorithm>
+
 
 
 
@@ -8,6 +10,10 @@
 // #################################################################################################
 
 
+uint32_t VulkanContext::s_logicalDevicesPerPhysicalDevice = 1;
+bool VulkanContext::s_created = false;
+
+
 // Singleton access
 VulkanContext& VulkanContext::getContext() {
 	static VulkanContext s_instance;
@@ -15,8 +21,20 @@ VulkanContext& VulkanContext::getContext() {
 }
 
 
+void VulkanContext::setLogicalDevicesPerPhysicalDevice(uint32_t count) {
+	if (count == 0) {
+		throw std::runtime_error("At least one logical device per physical device is required");
+	}
+	if (s_created) {
+		throw std::runtime_error("The number of logical devices must be set before the Vulkan context is created");
+	}
+	s_logicalDevicesPerPhysicalDevice = count;
+}
+
+
 // Initialize all components
 VulkanContext::VulkanContext() {
+	s_created = true;
     createInstance();
     pickPhysicalDevices();
     createDevicesAndQueues();
@@ -81,7 +99,7 @@ void VulkanContext::pickPhysicalDevices() {
     std::vector<VkPhysicalDevice> allDevices(deviceCount);
     vkEnumeratePhysicalDevices(instance, &deviceCount, allDevices.data());
 
-    // For each device, check if it has a compute queue
+    // For each device, check if it has a compute queue (listed once per logical device to create)
     for (const auto& pd : allDevices) {
         uint32_t queueFamilyCount = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(pd, &queueFamilyCount, nullptr);
@@ -90,8 +108,10 @@ void VulkanContext::pickPhysicalDevices() {
 
         for (uint32_t i = 0; i < queueFamilyCount; i++) {
             if (queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
-                physicalDevices.push_back(pd);
-                queueFamilyIndices.push_back(i);
+				for (uint32_t j = 0; j < s_logicalDevicesPerPhysicalDevice; j++) {
+					physicalDevices.push_back(pd);
+					queueFamilyIndices.push_back(i);
+				}
                 break;	// Pick the first compute queue found
             }
         }
@@ -99,14 +119,17 @@ void VulkanContext::pickPhysicalDevices() {
     if (physicalDevices.empty()) {
         throw std::runtime_error("No GPU with compute queue found");
     }
+	deviceCount = static_cast<uint32_t>(physicalDevices.size());	// Logical devices actually created
 }
 
 
 void VulkanContext::createDevicesAndQueues() {
     devices.resize(physicalDevices.size());
     queues.resize(physicalDevices.size());
+	deviceFeatures.resize(physicalDevices.size());
+	deviceLimits.resize(physicalDevices.size());
 
-	// Create a logical device for each physical device
+	// Create a logical device for each entry (a physical device is listed once per logical device)
     for (size_t i = 0; i < physicalDevices.size(); i++) {
         float queuePriority = 1.0f;
 
@@ -123,11 +146,63 @@ void VulkanContext::createDevicesAndQueues() {
         createInfo.pQueueCreateInfos = &queueCreateInfo;
 
 		// Specify the device extensions to enable
-		VkPhysicalDeviceFeatures deviceFeatures{};
 		std::vector<const char*> enabledExtensions(deviceExtensions.begin(), deviceExtensions.end());
+		for (const char* extension : optionalDeviceExtensions) {
+			if (isDeviceExtensionSupported(physicalDevices[i], extension)) {
+				enabledExtensions.push_back(extension);
+			}
+		}
 		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
 		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
-		createInfo.pEnabledFeatures = &deviceFeatures;
+
+		// Probe the optional features (16-bit storage is core in Vulkan 1.1, float16 arithmetic needs its extension)
+		bool float16Supported = isDeviceExtensionSupported(physicalDevices[i], VK_KHR_SHADER_FLOAT16_INT8_EXTENSION_NAME);
+
+		VkPhysicalDeviceShaderFloat16Int8FeaturesKHR float16Features{};
+		float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES_KHR;
+
+		VkPhysicalDevice16BitStorageFeatures storageFeatures{};
+		storageFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+		storageFeatures.pNext = float16Supported ? &float16Features : nullptr;
+
+		VkPhysicalDeviceFeatures2 supportedFeatures{};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &storageFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevices[i], &supportedFeatures);
+
+		deviceFeatures[i].storageBuffer16BitAccess = storageFeatures.storageBuffer16BitAccess == VK_TRUE;
+		deviceFeatures[i].shaderFloat16 = float16Supported && float16Features.shaderFloat16 == VK_TRUE;
+
+		// Only enable the features we use, the core features stay disabled
+		VkPhysicalDeviceShaderFloat16Int8FeaturesKHR enabledFloat16{};
+		enabledFloat16.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES_KHR;
+		enabledFloat16.shaderFloat16 = deviceFeatures[i].shaderFloat16 ? VK_TRUE : VK_FALSE;
+
+		VkPhysicalDevice16BitStorageFeatures enabledStorage{};
+		enabledStorage.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+		enabledStorage.storageBuffer16BitAccess = deviceFeatures[i].storageBuffer16BitAccess ? VK_TRUE : VK_FALSE;
+		enabledStorage.pNext = float16Supported ? &enabledFloat16 : nullptr;
+
+		VkPhysicalDeviceFeatures2 enabledFeatures{};
+		enabledFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		enabledFeatures.pNext = &enabledStorage;
+
+		createInfo.pNext = &enabledFeatures;
+		createInfo.pEnabledFeatures = nullptr;	// Must be null when VkPhysicalDeviceFeatures2 is chained
+
+		// Probe the compute limits (subgroup properties are core in Vulkan 1.1)
+		VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+		subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties{};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &subgroupProperties;
+		vkGetPhysicalDeviceProperties2(physicalDevices[i], &properties);
+
+		const VkPhysicalDeviceLimits& limits = properties.properties.limits;
+		deviceLimits[i].subgroupSize = std::max<uint32_t>(subgroupProperties.subgroupSize, 1);
+		deviceLimits[i].maxWorkgroupSize = std::min(limits.maxComputeWorkGroupSize[0], limits.maxComputeWorkGroupInvocations);
+		deviceLimits[i].maxSharedMemorySize = limits.maxComputeSharedMemorySize;
 
 		// Create the logical device
 		if (vkCreateDevice(physicalDevices[i], &createInfo, nullptr, &devices[i]) != VK_SUCCESS) {
@@ -138,8 +213,24 @@ void VulkanContext::createDevicesAndQueues() {
 }
 
 
+bool VulkanContext::isDeviceExtensionSupported(VkPhysicalDevice device, const char* extension) const {
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+	for (const auto& properties : extensions) {
+		if (std::string(properties.extensionName) == extension) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
 void VulkanContext::createCommandPools() {
     commandPools.resize(devices.size());
+	queueMutexes.resize(devices.size());
 
 	// Create a command pool for each device
     for (size_t i = 0; i < devices.size(); i++) {
@@ -154,6 +245,7 @@ void VulkanContext::createCommandPools() {
         if (vkCreateCommandPool(devices[i], &poolInfo, nullptr, &commandPools[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create command pool for device " + std::to_string(i));
         }
+		queueMutexes[i] = std::make_unique<std::mutex>();
     }
 }
 
@@ -163,7 +255,39 @@ void VulkanContext::createCommandPools() {
 // #################################################################################################
 
 
-void VulkanContext::createBufferAndMemory(VkDevice device, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) const {
+void VulkanContext::createBufferAndMemory(VkDevice device, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory,
+										  VkMemoryPropertyFlags properties) const {
+	// Find the index of the logical device (required to query the right physical device)
+	auto it = std::find(devices.begin(), devices.end(), device);
+	if (it == devices.end()) {
+		throw std::runtime_error("Unable to create a buffer for an unknown device");
+	}
+	uint32_t deviceIndex = static_cast<uint32_t>(it - devices.begin());
+
+	// Create the buffer
+	buffer = createBuffer(device, size);
+
+    // Get memory requirements
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+	// Define the memory allocation info
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = findMemoryType(deviceIndex, memRequirements.memoryTypeBits, properties);
+
+	// Allocate memory for the buffer
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		vkDestroyBuffer(device, buffer, nullptr);
+        throw std::runtime_error("Failed to allocate memory for the buffer");
+    }
+	// Bind the buffer to the memory
+    vkBindBufferMemory(device, buffer, memory, 0);
+}
+
+
+VkBuffer VulkanContext::createBuffer(VkDevice device, VkDeviceSize size) const {
     // Define the buffer info
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -174,46 +298,28 @@ void VulkanContext::createBufferAndMemory(VkDevice device, VkDeviceSize size, Vk
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
 	// Create the buffer
+	VkBuffer buffer;
     if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create buffer");
     }
+	return buffer;
+}
 
-    // Get memory requirements
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
+uint32_t VulkanContext::findMemoryType(uint32_t deviceIndex, uint32_t typeBits, VkMemoryPropertyFlags properties) const {
     // Get the memory properties of the physical device
     VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevices[0], &memProperties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevices[deviceIndex], &memProperties);
 
-	bool found = false;
-    uint32_t memoryTypeIndex = 0;
 	// Find a valid memory type for the buffer on the physical device
     for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if (memRequirements.memoryTypeBits & (1 << i)) {											// The memory type is supported by the buffer
-            if (memProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {	// We use DEVICE_LOCAL memory -> VRAM
-                memoryTypeIndex = i;
-                found = true;
-                break;
+        if (typeBits & (1 << i)) {															// The memory type is supported by the buffer
+            if ((memProperties.memoryTypes[i].propertyFlags & properties) == properties) {	// DEVICE_LOCAL -> VRAM, HOST_VISIBLE -> staging
+                return i;
             }
         }
     }
-    if (!found) {
-        throw std::runtime_error("No valid memory type found for the buffer");
-    }
-
-	// Define the memory allocation info
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = memoryTypeIndex;
-
-	// Allocate memory for the buffer
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate memory for the buffer");
-    }
-	// Bind the buffer to the memory
-    vkBindBufferMemory(device, buffer, memory, 0);
+	throw std::runtime_error("No valid memory type found for the buffer");
 }
 
 
@@ -235,4 +341,99 @@ std::pair<VkDeviceSize, VkDeviceSize> VulkanContext::getMemoryUsage(VkPhysicalDe
         }
     }
     return {0, 0};
-}
\ No newline at end of file
+}
+
+
+// #################################################################################################
+// ###   VulkanContext: Command submission
+// #################################################################################################
+
+
+void VulkanContext::submitAndWait(uint32_t deviceIndex, const std::function<void(VkCommandBuffer)>& record) {
+	Submission submission = submit(deviceIndex, record);
+	wait(submission);
+}
+
+
+Submission VulkanContext::submit(uint32_t deviceIndex, const std::function<void(VkCommandBuffer)>& record) {
+	if (deviceIndex >= devices.size()) {
+		throw std::runtime_error("Unable to submit commands to an invalid device index");
+	}
+	std::lock_guard<std::mutex> lock(*queueMutexes[deviceIndex]);
+	VkDevice device = devices[deviceIndex];
+
+	Submission submission;
+	submission.deviceIndex = deviceIndex;
+
+	// Allocate a one-time command buffer
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = commandPools[deviceIndex];
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	if (vkAllocateCommandBuffers(device, &allocInfo, &submission.commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate a command buffer for device " + std::to_string(deviceIndex));
+	}
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	if (vkCreateFence(device, &fenceInfo, nullptr, &submission.fence) != VK_SUCCESS) {
+		vkFreeCommandBuffers(device, commandPools[deviceIndex], 1, &submission.commandBuffer);
+		throw std::runtime_error("Failed to create a fence for device " + std::to_string(deviceIndex));
+	}
+
+	// Record the commands (the fence and the command buffer are released if the recording fails)
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	try {
+		if (vkBeginCommandBuffer(submission.commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to begin a command buffer on device " + std::to_string(deviceIndex));
+		}
+		record(submission.commandBuffer);
+		if (vkEndCommandBuffer(submission.commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to record the commands on device " + std::to_string(deviceIndex));
+		}
+	} catch (...) {
+		vkDestroyFence(device, submission.fence, nullptr);
+		vkFreeCommandBuffers(device, commandPools[deviceIndex], 1, &submission.commandBuffer);
+		throw;
+	}
+
+	// Submit
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &submission.commandBuffer;
+
+	if (vkQueueSubmit(queues[deviceIndex], 1, &submitInfo, submission.fence) != VK_SUCCESS) {
+		vkDestroyFence(device, submission.fence, nullptr);
+		vkFreeCommandBuffers(device, commandPools[deviceIndex], 1, &submission.commandBuffer);
+		throw std::runtime_error("Failed to submit commands on device " + std::to_string(deviceIndex));
+	}
+	return submission;
+}
+
+
+void VulkanContext::wait(Submission& submission) {
+	if (submission.fence == VK_NULL_HANDLE) {
+		return;
+	}
+	uint32_t deviceIndex = submission.deviceIndex;
+	VkDevice device = devices[deviceIndex];
+
+	// Fences don't need the queue lock, only the command pool does
+	VkResult result = vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+	vkDestroyFence(device, submission.fence, nullptr);
+	{
+		std::lock_guard<std::mutex> lock(*queueMutexes[deviceIndex]);
+		vkFreeCommandBuffers(device, commandPools[deviceIndex], 1, &submission.commandBuffer);
+	}
+	submission.fence = VK_NULL_HANDLE;
+	submission.commandBuffer = VK_NULL_HANDLE;
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to execute commands on device " + std::to_string(deviceIndex));
+	}
+}
@@ -0,0 +1,119 @@
+// Memory manager paths: cache misses and hits, releases, and cache eviction with many cached buffers
+
+#include "BenchSuite.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define BATCH_SIZE 256				// Operations per timed run
+#define BUFFER_SIZE (1 << 16)
+#define LARGE_CACHE_ENTRIES 4096	// Buffers of distinct sizes, from 256 bytes up
+#define LARGE_CACHE_SIZE_STEP 4
+
+
+static VkDeviceSize getLargeCacheSize(size_t index) {
+	return 256 + LARGE_CACHE_SIZE_STEP * index;
+}
+
+
+// Allocates and releases the buffers of the large cache (all different sizes)
+static void fillLargeCache() {
+	auto& memMgr = MemoryManager::getManager();
+	std::vector<MemoryHandle> handles(LARGE_CACHE_ENTRIES);
+	for (size_t i = 0; i < LARGE_CACHE_ENTRIES; i++) {
+		handles[i] = memMgr.getBuffer(getLargeCacheSize(i), 0);
+	}
+	for (const MemoryHandle& handle : handles) {
+		memMgr.releaseBuffer(handle);
+	}
+}
+
+
+void runAllocatorBenchmarks(BenchSuite& suite) {
+	auto& memMgr = MemoryManager::getManager();
+	std::vector<MemoryHandle> handles(BATCH_SIZE);
+
+	auto getAll = [&] {
+		for (MemoryHandle& handle : handles) {
+			handle = memMgr.getBuffer(BUFFER_SIZE, 0);
+		}
+	};
+	auto releaseAll = [&] {
+		for (const MemoryHandle& handle : handles) {
+			memMgr.releaseBuffer(handle);
+		}
+	};
+
+	// New allocations: nothing to reuse in the cache
+	memMgr.emptyCache(0);
+	suite.measure({
+		.name = "allocator/get_buffer_miss",
+		.operations = BATCH_SIZE,
+		.setup = [&] { memMgr.emptyCache(0); },
+		.run = getAll,
+		.teardown = releaseAll,
+	});
+
+	// Reuse of cached buffers (released by the previous run)
+	suite.measure({
+		.name = "allocator/get_buffer_hit",
+		.operations = BATCH_SIZE,
+		.run = getAll,
+		.teardown = releaseAll,
+	});
+
+	suite.measure({
+		.name = "allocator/release_buffer",
+		.operations = BATCH_SIZE,
+		.setup = getAll,
+		.run = releaseAll,
+	});
+
+	// Hits among many cached buffers, sizes drawn with a fixed seed
+	memMgr.emptyCache(0);
+	fillLargeCache();
+	std::mt19937_64 generator(suite.getConfig().seed);
+	std::uniform_int_distribution<size_t> distribution(0, LARGE_CACHE_ENTRIES - 1);
+	std::vector<VkDeviceSize> sizes(BATCH_SIZE);
+	for (VkDeviceSize& size : sizes) {
+		size = getLargeCacheSize(distribution(generator));
+	}
+	std::ranges::sort(sizes);
+	sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());		// Each size is cached once
+	std::ranges::shuffle(sizes, generator);
+
+	std::vector<MemoryHandle> largeCacheHandles(sizes.size());
+	suite.measure({
+		.name = "allocator/get_buffer_hit_large_cache",
+		.operations = static_cast<uint32_t>(sizes.size()),
+		.run = [&] {
+			for (size_t i = 0; i < sizes.size(); i++) {
+				largeCacheHandles[i] = memMgr.getBuffer(sizes[i], 0);
+			}
+		},
+		.teardown = [&] {
+			for (const MemoryHandle& handle : largeCacheHandles) {
+				memMgr.releaseBuffer(handle);
+			}
+		},
+	});
+
+	// Eviction: the whole cache, then the least recently used buffers only
+	suite.measure({
+		.name = "allocator/empty_cache_large",
+		.work = LARGE_CACHE_ENTRIES,
+		.workUnit = "buffers",
+		.setup = fillLargeCache,
+		.run = [&] { memMgr.emptyCache(0); },
+	});
+
+	suite.measure({
+		.name = "allocator/empty_cache_partial_large",
+		.setup = fillLargeCache,
+		.run = [&] { memMgr.emptyCache(BUFFER_SIZE); },
+		.teardown = [&] { memMgr.emptyCache(0); },
+	});
+
+	memMgr.emptyCache(0);
+}
@@ -0,0 +1,103 @@
+// vknp_bench: allocator, startup, transfer, kernel, crossover, random and sort benchmarks with statistical summaries and JSON output
+// Usage: vknp_bench [--json <file>] [--filter <substring>] [--warmup <runs>] [--runs <runs>] [--seed <seed>]
+// The sizes are kept moderate so that a run on lavapipe (CPU Vulkan driver) takes a few minutes at most
+
+#include "BenchSuite.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+static void printUsage() {
+	std::cerr << "Usage: vknp_bench [--json <file>] [--filter <substring>] [--warmup <runs>] [--runs <runs>] [--seed <seed>]" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+	BenchConfig config;
+	config.executable = argv[0];
+	std::string jsonPath;
+
+	try {
+		for (int i = 1; i < argc; i++) {
+			std::string arg = argv[i];
+			if (arg == "--startup-child") {
+				return runStartupChild();
+			}
+			if (arg == "--help") {
+				printUsage();
+				return EXIT_SUCCESS;
+			}
+			if (i + 1 >= argc) {
+				printUsage();
+				return EXIT_FAILURE;
+			}
+
+			std::string value = argv[++i];
+			if (arg == "--json") {
+				jsonPath = value;
+			} else if (arg == "--filter") {
+				config.filter = value;
+			} else if (arg == "--warmup") {
+				config.warmupRuns = static_cast<uint32_t>(std::stoul(value));
+			} else if (arg == "--runs") {
+				config.timedRuns = std::max(static_cast<uint32_t>(std::stoul(value)), 1u);
+			} else if (arg == "--seed") {
+				config.seed = std::stoull(value);
+			} else {
+				printUsage();
+				return EXIT_FAILURE;
+			}
+		}
+	} catch (const std::logic_error&) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	BenchSuite suite(config);
+
+	try {
+		// Before the initialization of this process: the children measure a cold start
+		runStartupBenchmarks(suite);
+
+		auto& dispatcher = Dispatcher::getDispatcher();
+		dispatcher.init();
+		if (!dispatcher.hasVulkan()) {
+			std::cerr << "No Vulkan device available" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(VulkanContext::getContext().getPhysicalDevices()[0], &properties);
+		std::string deviceName = properties.deviceName;
+		std::cerr << "Device: " << deviceName << std::endl;
+
+		runAllocatorBenchmarks(suite);
+		runTransferBenchmarks(suite);
+		runKernelBenchmarks(suite);
+		runCrossoverBenchmarks(suite);
+		runRandomBenchmarks(suite);
+		runSortBenchmarks(suite);
+
+		dispatcher.destroy();
+
+		std::cout << "\n" << deviceName << std::endl;
+		suite.printSummary(std::cout);
+
+		if (!jsonPath.empty()) {
+			std::ofstream file(jsonPath);
+			if (!file) {
+				throw std::runtime_error("Unable to write " + jsonPath);
+			}
+			suite.writeJson(file, deviceName);
+		}
+
+	} catch (const std::runtime_error& e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
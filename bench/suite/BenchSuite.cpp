@@ -0,0 +1,177 @@
+#include "BenchSuite.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+
+
+// #################################################################################################
+// ###   Statistics
+// #################################################################################################
+
+
+BenchStats BenchStats::compute(std::vector<double> samples) {
+	BenchStats stats;
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	size_t count = samples.size();
+	stats.min = samples.front();
+	stats.max = samples.back();
+	stats.median = count % 2 == 1 ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+	stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(count);
+
+	// Sample standard deviation
+	if (count > 1) {
+		double squares = 0.0;
+		for (double sample : samples) {
+			squares += (sample - stats.mean) * (sample - stats.mean);
+		}
+		stats.stddev = std::sqrt(squares / static_cast<double>(count - 1));
+	}
+	return stats;
+}
+
+
+
+// #################################################################################################
+// ###   Measures
+// #################################################################################################
+
+
+bool BenchSuite::isSelected(const std::string& name) const {
+	return config.filter.empty() || name.find(config.filter) != std::string::npos;
+}
+
+
+void BenchSuite::measure(const BenchCase& bench) {
+	if (!isSelected(bench.name)) {
+		return;
+	}
+
+	std::vector<double> samples;
+	for (uint32_t i = 0; i < config.warmupRuns + config.timedRuns; i++) {
+		if (bench.setup) {
+			bench.setup();
+		}
+		auto start = std::chrono::steady_clock::now();
+		bench.run();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (bench.teardown) {
+			bench.teardown();
+		}
+
+		if (i >= config.warmupRuns) {
+			samples.push_back(seconds / bench.operations);
+		}
+	}
+	record(bench, samples);
+}
+
+
+void BenchSuite::record(const BenchCase& bench, const std::vector<double>& samples) {
+	BenchResult result;
+	result.bench = bench;
+	result.runs = static_cast<uint32_t>(samples.size());
+	result.stats = BenchStats::compute(samples);
+
+	// Only the description is kept
+	result.bench.setup = nullptr;
+	result.bench.run = nullptr;
+	result.bench.teardown = nullptr;
+	results.push_back(result);
+
+	std::cerr << "  " << bench.name << std::endl;
+}
+
+
+
+// #################################################################################################
+// ###   Reports
+// #################################################################################################
+
+
+// Throughput in a readable unit (bytes -> GB/s, flops -> GFLOP/s, others -> M<unit>/s)
+static std::string formatThroughput(const BenchResult& result) {
+	if (result.bench.work <= 0.0) {
+		return "";
+	}
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(2);
+	if (result.bench.workUnit == "bytes") {
+		text << result.throughput() / 1e9 << " GB/s";
+	} else if (result.bench.workUnit == "flops") {
+		text << result.throughput() / 1e9 << " GFLOP/s";
+	} else {
+		text << result.throughput() / 1e6 << " M" << result.bench.workUnit << "/s";
+	}
+	return text.str();
+}
+
+
+void BenchSuite::printSummary(std::ostream& out) const {
+	out << std::left << std::setw(44) << "benchmark" << std::right << std::setw(14) << "median (us)"
+		<< std::setw(14) << "min (us)" << std::setw(10) << "cv (%)" << std::setw(20) << "throughput" << std::endl;
+
+	out << std::fixed;
+	for (const BenchResult& result : results) {
+		const BenchStats& stats = result.stats;
+		double variation = stats.mean > 0.0 ? 100.0 * stats.stddev / stats.mean : 0.0;
+		out << std::left << std::setw(44) << result.bench.name << std::right
+			<< std::setprecision(2) << std::setw(14) << stats.median * 1e6 << std::setw(14) << stats.min * 1e6
+			<< std::setprecision(1) << std::setw(10) << variation << std::setw(20) << formatThroughput(result) << std::endl;
+	}
+	out << std::defaultfloat;
+}
+
+
+static std::string escapeJson(const std::string& text) {
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			escaped += ' ';
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+
+// Times in seconds per operation, throughput in work units per second
+void BenchSuite::writeJson(std::ostream& out, const std::string& deviceName) const {
+	out << std::setprecision(9);
+	out << "{\n";
+	out << "  \"suite\": \"vknp_bench\",\n";
+	out << "  \"version\": 1,\n";
+	out << "  \"device\": \"" << escapeJson(deviceName) << "\",\n";
+	out << "  \"config\": { \"warmup_runs\": " << config.warmupRuns << ", \"timed_runs\": " << config.timedRuns
+		<< ", \"seed\": " << config.seed << " },\n";
+	out << "  \"results\": [";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& result = results[i];
+		const BenchStats& stats = result.stats;
+		out << (i == 0 ? "\n" : ",\n");
+		out << "    { \"name\": \"" << escapeJson(result.bench.name) << "\", \"runs\": " << result.runs
+			<< ", \"operations\": " << result.bench.operations
+			<< ", \"min\": " << stats.min << ", \"median\": " << stats.median << ", \"mean\": " << stats.mean
+			<< ", \"stddev\": " << stats.stddev << ", \"max\": " << stats.max;
+		if (result.bench.work > 0.0) {
+			out << ", \"work\": " << result.bench.work << ", \"work_unit\": \"" << result.bench.workUnit
+				<< "\", \"throughput\": " << result.throughput();
+		}
+		out << " }";
+	}
+	out << "\n  ]\n}\n";
+}
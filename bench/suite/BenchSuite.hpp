@@ -0,0 +1,94 @@
+#pragma once
+
+#include "VKNP.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define BENCH_SEED 42
+#define BENCH_WARMUP_RUNS 3
+#define BENCH_TIMED_RUNS 15
+
+
+
+// Options of a run (command line of vknp_bench)
+struct BenchConfig {
+	uint32_t warmupRuns = BENCH_WARMUP_RUNS;
+	uint32_t timedRuns = BENCH_TIMED_RUNS;
+	uint64_t seed = BENCH_SEED;
+	std::string filter;			// Only run the benchmarks whose name contains this string
+	std::string executable;		// Path of vknp_bench, to start the child processes of the startup benchmarks
+};
+
+
+// One measured operation, the names are stable across versions so that runs can be compared
+struct BenchCase {
+	std::string name = "";					// <group>/<operation>[/<size>]
+	double work = 0.0;						// Work done by one operation, 0 if no throughput is reported
+	std::string workUnit = "";				// bytes, elements, flops, buffers
+	uint32_t operations = 1;				// Operations per run, the statistics are per operation
+	std::function<void()> setup = nullptr;		// Before each run, not timed
+	std::function<void()> run = nullptr;
+	std::function<void()> teardown = nullptr;	// After each run, not timed
+};
+
+
+// Summary of the timed runs, in seconds per operation
+struct BenchStats {
+	double min = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+	double stddev = 0.0;
+	double max = 0.0;
+
+	static BenchStats compute(std::vector<double> samples);
+};
+
+
+struct BenchResult {
+	BenchCase bench;
+	uint32_t runs = 0;
+	BenchStats stats;
+
+	// Work per second, based on the median
+	double throughput() const { return bench.work > 0.0 ? bench.work / stats.median : 0.0; }
+};
+
+
+class BenchSuite {
+public:
+	explicit BenchSuite(const BenchConfig& config) : config(config) {}
+
+	const BenchConfig& getConfig() const { return config; }
+	const std::vector<BenchResult>& getResults() const { return results; }
+	bool isSelected(const std::string& name) const;
+
+	// Warmup runs, then timed runs (skipped if filtered out)
+	void measure(const BenchCase& bench);
+
+	// Samples measured elsewhere (startup benchmarks: in child processes)
+	void record(const BenchCase& bench, const std::vector<double>& samples);
+
+	void printSummary(std::ostream& out) const;
+	void writeJson(std::ostream& out, const std::string& deviceName) const;
+
+private:
+	BenchConfig config;
+	std::vector<BenchResult> results;
+};
+
+
+// Benchmark groups
+void runStartupBenchmarks(BenchSuite& suite);
+void runAllocatorBenchmarks(BenchSuite& suite);
+void runTransferBenchmarks(BenchSuite& suite);
+void runKernelBenchmarks(BenchSuite& suite);
+void runCrossoverBenchmarks(BenchSuite& suite);
+void runRandomBenchmarks(BenchSuite& suite);
+void runSortBenchmarks(BenchSuite& suite);
+
+// Body of the startup child processes: initializes the library once and prints the timings
+int runStartupChild();
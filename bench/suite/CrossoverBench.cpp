@@ -0,0 +1,69 @@
+// CPU and Vulkan backends on growing tensors, to find the size where the GPU starts to win
+// vulkan: device-resident inputs, vulkan_upload: host inputs which pay the upload
+
+#include "BenchSuite.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define CROSSOVER_MIN_ELEMENTS (1 << 6)
+#define CROSSOVER_MAX_ELEMENTS (1 << 24)
+#define CROSSOVER_MIN_MATMUL 16
+#define CROSSOVER_MAX_MATMUL 1024
+
+
+// Median of the last measured case, 0 if it was filtered out
+static double lastMedian(const BenchSuite& suite, const std::string& name) {
+	const auto& results = suite.getResults();
+	return !results.empty() && results.back().bench.name == name ? results.back().stats.median : 0.0;
+}
+
+
+void runCrossoverBenchmarks(BenchSuite& suite) {
+	auto& dispatcher = Dispatcher::getDispatcher();
+	std::cerr << "CPU: " << getSimdLevelName(dispatcher.getCpuBackend().getSimdLevel())
+			  << ", " << dispatcher.getCpuBackend().getThreadCount() << " threads" << std::endl;
+
+	// Measures one operation on the three paths, returns whether the device-resident one beat the CPU
+	auto compare = [&](const std::string& operation, size_t size, double work, const std::string& workUnit,
+					   const std::function<void(const Tensor&)>& run, const Tensor& host, const Tensor& device) {
+		const std::string suffix = "/" + std::to_string(size);
+
+		dispatcher.setPreference(BackendPreference::Cpu);
+		suite.measure({ .name = "crossover/" + operation + "_cpu" + suffix, .work = work, .workUnit = workUnit, .run = [&] { run(host); } });
+		double cpu = lastMedian(suite, "crossover/" + operation + "_cpu" + suffix);
+
+		dispatcher.setPreference(BackendPreference::Vulkan);
+		suite.measure({ .name = "crossover/" + operation + "_vulkan" + suffix, .work = work, .workUnit = workUnit, .run = [&] { run(device); } });
+		double gpu = lastMedian(suite, "crossover/" + operation + "_vulkan" + suffix);
+		suite.measure({ .name = "crossover/" + operation + "_vulkan_upload" + suffix, .work = work, .workUnit = workUnit, .run = [&] { run(host); } });
+
+		return cpu > 0.0 && gpu > 0.0 && gpu < cpu;
+	};
+
+	size_t addCrossover = 0;
+	for (size_t size = CROSSOVER_MIN_ELEMENTS; size <= CROSSOVER_MAX_ELEMENTS; size <<= 2) {
+		Tensor host = Tensor::fromVector(std::vector<float>(size, 1.0f), { size });
+		Tensor device = host.to(TensorLocation::Device);
+		bool faster = compare("add", size, 3.0 * size * sizeof(float), "bytes", [&](const Tensor& x) { dispatcher.add(x, x); }, host, device);
+		if (addCrossover == 0 && faster) {
+			addCrossover = size;
+		}
+	}
+
+	// Square matrices: 2 n^3 flops
+	size_t matmulCrossover = 0;
+	for (size_t n = CROSSOVER_MIN_MATMUL; n <= CROSSOVER_MAX_MATMUL; n <<= 1) {
+		Tensor host = Tensor::fromVector(std::vector<float>(n * n, 1.0f), { n, n });
+		Tensor device = host.to(TensorLocation::Device);
+		bool faster = compare("matmul", n, 2.0 * n * n * n, "flops", [&](const Tensor& x) { dispatcher.matmul(x, x); }, host, device);
+		if (matmulCrossover == 0 && faster) {
+			matmulCrossover = n;
+		}
+	}
+
+	std::cerr << "Crossover (device-resident inputs): add >= " << addCrossover << " elements, matmul >= " << matmulCrossover
+			  << " (0: the CPU was faster at every measured size, CostModel::minDeviceElements can be raised)" << std::endl;
+	dispatcher.setPreference(BackendPreference::Auto);
+}
@@ -0,0 +1,89 @@
+// Throughput of the Vulkan kernels on device tensors (inputs generated on the device with a fixed seed),
+// for each storage dtype: 16-bit storage halves the traffic, the arithmetic stays in float32
+
+#include "BenchSuite.hpp"
+
+#include <string>
+#include <vector>
+
+#define ELEMENTWISE_COUNT (1 << 22)
+#define BROADCAST_ROWS 4096
+#define BROADCAST_COLUMNS 1024
+
+
+void runKernelBenchmarks(BenchSuite& suite) {
+	auto& dispatcher = Dispatcher::getDispatcher();
+	dispatcher.setPreference(BackendPreference::Vulkan);
+	uint64_t seed = suite.getConfig().seed;
+	bool has16Bit = VulkanContext::getContext().getDeviceFeatures()[0].storageBuffer16BitAccess;
+
+	auto deviceRandom = [&](const std::vector<size_t>& shape, DType dtype = DType::Float32) {
+		return dispatcher.random(shape, RandomSpec::uniform(-1.0f, 1.0f, seed++), TensorLocation::Device, 0, dtype);
+	};
+
+	std::vector<DType> dtypes = { DType::Float32 };
+	if (has16Bit) {
+		dtypes.push_back(DType::Float16);
+		dtypes.push_back(DType::BFloat16);
+	}
+
+	// Elementwise: bytes read and written
+	const size_t count = ELEMENTWISE_COUNT;
+	for (DType dtype : dtypes) {
+		Tensor a = deviceRandom({ count }, dtype);
+		Tensor b = deviceRandom({ count }, dtype);
+		double elementSize = static_cast<double>(getDTypeSize(dtype));
+		std::string name = std::string("_") + getDTypeSuffix(dtype) + "/" + std::to_string(count);
+
+		suite.measure({
+			.name = "kernel/add" + name,
+			.work = 3.0 * count * elementSize,
+			.workUnit = "bytes",
+			.run = [&] { dispatcher.add(a, b); },
+		});
+		suite.measure({
+			.name = "kernel/exp" + name,
+			.work = 2.0 * count * elementSize,
+			.workUnit = "bytes",
+			.run = [&] { dispatcher.exp(a); },
+		});
+	}
+
+	// Broadcast bias add: [rows, columns] + [columns]
+	{
+		Tensor a = deviceRandom({ BROADCAST_ROWS, BROADCAST_COLUMNS });
+		Tensor bias = deviceRandom({ BROADCAST_COLUMNS });
+		suite.measure({
+			.name = "kernel/add_broadcast_f32/" + std::to_string(BROADCAST_ROWS * BROADCAST_COLUMNS),
+			.work = (2.0 * BROADCAST_ROWS + 1.0) * BROADCAST_COLUMNS * sizeof(float),
+			.workUnit = "bytes",
+			.run = [&] { dispatcher.add(a, bias); },
+		});
+	}
+
+	if (has16Bit) {
+		Tensor a = deviceRandom({ count });
+		suite.measure({
+			.name = "kernel/cast_f32_f16/" + std::to_string(count),
+			.work = count * (sizeof(float) + sizeof(uint16_t)),
+			.workUnit = "bytes",
+			.run = [&] { dispatcher.cast(a, DType::Float16); },
+		});
+	}
+
+	// Matmul: 2 n^3 flops, float32 accumulation for every dtype
+	for (size_t n : { 256, 512, 1024 }) {
+		for (DType dtype : dtypes) {
+			Tensor a = deviceRandom({ n, n }, dtype);
+			Tensor b = deviceRandom({ n, n }, dtype);
+			suite.measure({
+				.name = std::string("kernel/matmul_") + getDTypeSuffix(dtype) + "/" + std::to_string(n),
+				.work = 2.0 * n * n * n,
+				.workUnit = "flops",
+				.run = [&] { dispatcher.matmul(a, b); },
+			});
+		}
+	}
+
+	dispatcher.setPreference(BackendPreference::Auto);
+}
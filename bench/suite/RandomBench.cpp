@@ -0,0 +1,66 @@
+// On-device random generation against host generation followed by an upload, and fused dropout against an explicit mask
+
+#include "BenchSuite.hpp"
+
+#include <string>
+#include <utility>
+
+#define RANDOM_COUNT (1 << 22)
+
+
+void runRandomBenchmarks(BenchSuite& suite) {
+	auto& dispatcher = Dispatcher::getDispatcher();
+	uint64_t seed = suite.getConfig().seed;
+	bool has16Bit = VulkanContext::getContext().getDeviceFeatures()[0].storageBuffer16BitAccess;
+	const size_t count = RANDOM_COUNT;
+	const std::string suffix = "/" + std::to_string(count);
+
+	// Bytes of written output
+	const std::pair<const char*, RandomSpec> specs[] = {
+		{ "uniform", RandomSpec::uniform(0.0f, 1.0f, seed) },
+		{ "normal", RandomSpec::normal(0.0f, 1.0f, seed) },
+		{ "bernoulli", RandomSpec::bernoulli(0.5f, seed) },
+	};
+	for (const auto& [distribution, spec] : specs) {
+		for (DType dtype : { DType::Float32, DType::Float16 }) {
+			if (dtype != DType::Float32 && !has16Bit) {
+				continue;
+			}
+			std::string name = std::string("random/") + distribution + "_" + getDTypeSuffix(dtype);
+			double bytes = static_cast<double>(count) * getDTypeSize(dtype);
+
+			suite.measure({
+				.name = name + "/device" + suffix,
+				.work = bytes,
+				.workUnit = "bytes",
+				.run = [&] { dispatcher.random({ count }, spec, TensorLocation::Device, 0, dtype); },
+			});
+			suite.measure({
+				.name = name + "/host_upload" + suffix,
+				.work = bytes,
+				.workUnit = "bytes",
+				.run = [&] { dispatcher.random({ count }, spec, TensorLocation::Host, 0, dtype).to(TensorLocation::Device); },
+			});
+		}
+	}
+
+	// Dropout: read + write of the activations
+	dispatcher.setPreference(BackendPreference::Vulkan);
+	Tensor x = dispatcher.random({ count }, RandomSpec::normal(0.0f, 1.0f, seed), TensorLocation::Device);
+	suite.measure({
+		.name = "random/dropout_fused" + suffix,
+		.work = 2.0 * count * sizeof(float),
+		.workUnit = "bytes",
+		.run = [&] { dispatcher.dropout(x, 0.1f, seed); },
+	});
+	suite.measure({
+		.name = "random/dropout_separate" + suffix,
+		.work = 2.0 * count * sizeof(float),
+		.workUnit = "bytes",
+		.run = [&] {
+			Tensor mask = dispatcher.random({ count }, RandomSpec::bernoulli(0.9f, seed), TensorLocation::Device);
+			dispatcher.scale(dispatcher.mul(x, mask), 1.0f / 0.9f);
+		},
+	});
+	dispatcher.setPreference(BackendPreference::Auto);
+}
@@ -0,0 +1,87 @@
+// Device radix sort, scan and compaction on raw buffers across input sizes, host std::sort for reference (keys per second)
+
+#include "BenchSuite.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+template <typename T>
+static void restore(const MemoryHandle& handle, const std::vector<T>& values) {
+	MemoryManager::getManager().writeBuffer(handle, values.data(), values.size() * sizeof(T));
+}
+
+
+template <typename T>
+static MemoryHandle upload(const std::vector<T>& values) {
+	MemoryHandle handle = MemoryManager::getManager().getBuffer(values.size() * sizeof(T), 0);
+	restore(handle, values);
+	return handle;
+}
+
+
+void runSortBenchmarks(BenchSuite& suite) {
+	auto& memMgr = MemoryManager::getManager();
+	std::mt19937_64 generator(suite.getConfig().seed);
+
+	for (uint32_t count : { 1u << 12, 1u << 16, 1u << 20, 1u << 22 }) {
+		std::vector<uint64_t> wideKeys(count);
+		std::vector<uint32_t> keys(count);
+		std::vector<uint32_t> flags(count);
+		std::vector<float> floatKeys(count);
+		for (uint32_t i = 0; i < count; i++) {
+			wideKeys[i] = generator();
+			keys[i] = static_cast<uint32_t>(wideKeys[i]);
+			flags[i] = keys[i] & 1;
+			floatKeys[i] = static_cast<float>(static_cast<int32_t>(keys[i])) * 1e-6f;
+		}
+
+		MemoryHandle keyBuffer = upload(keys);
+		MemoryHandle payloadBuffer = upload(keys);
+		MemoryHandle wideBuffer = upload(wideKeys);
+		MemoryHandle floatBuffer = upload(floatKeys);
+		MemoryHandle flagBuffer = upload(flags);
+		MemoryHandle output = memMgr.getBuffer(count * sizeof(uint32_t), 0);
+		MemoryHandle outputCount = memMgr.getBuffer(sizeof(uint32_t), 0);
+
+		const std::string suffix = "/" + std::to_string(count);
+		auto keysCase = [&](const std::string& name, std::function<void()> run, std::function<void()> setup = nullptr) {
+			suite.measure({
+				.name = "sort/" + name + suffix,
+				.work = static_cast<double>(count),
+				.workUnit = "keys",
+				.setup = std::move(setup),
+				.run = std::move(run),
+			});
+		};
+
+		// The sorts run in place: the random keys are uploaded again before each run (sorted inputs give coalesced scatters)
+		keysCase("radix_u32", [&] { Primitives::radixSort(0, keyBuffer, MemoryHandle{}, count, SortKeyType::Uint32); },
+				 [&] { restore(keyBuffer, keys); });
+		keysCase("radix_u32_payload", [&] { Primitives::radixSort(0, keyBuffer, payloadBuffer, count, SortKeyType::Uint32); },
+				 [&] { restore(keyBuffer, keys); restore(payloadBuffer, keys); });
+		keysCase("radix_u64", [&] { Primitives::radixSort(0, wideBuffer, MemoryHandle{}, count, SortKeyType::Uint64); },
+				 [&] { restore(wideBuffer, wideKeys); });
+		keysCase("radix_f32", [&] { Primitives::radixSort(0, floatBuffer, MemoryHandle{}, count, SortKeyType::Float32); },
+				 [&] { restore(floatBuffer, floatKeys); });
+		keysCase("exclusive_scan_u32", [&] { Primitives::exclusiveScan(0, flagBuffer, output, count); });
+		keysCase("compact_u32", [&] { Primitives::compact(0, payloadBuffer, flagBuffer, output, outputCount, count); });
+
+		// The copy is made before each run, only the sort is timed
+		std::vector<uint32_t> copy;
+		suite.measure({
+			.name = "sort/host_std_sort_u32" + suffix,
+			.work = static_cast<double>(count),
+			.workUnit = "keys",
+			.setup = [&] { copy = keys; },
+			.run = [&] { std::sort(copy.begin(), copy.end()); },
+		});
+
+		for (const MemoryHandle& handle : { keyBuffer, payloadBuffer, wideBuffer, floatBuffer, flagBuffer, output, outputCount }) {
+			memMgr.releaseBuffer(handle);
+		}
+	}
+}
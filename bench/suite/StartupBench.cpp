@@ -0,0 +1,88 @@
+// Startup time: each sample is a fresh process, the singletons can only be initialized once per process
+
+#include "BenchSuite.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define STARTUP_ELEMENTS 1024
+
+
+// Seconds elapsed since start
+static double elapsed(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int runStartupChild() {
+	try {
+		// Instance, devices and queues
+		auto start = std::chrono::steady_clock::now();
+		VulkanContext::getContext();
+		double context = elapsed(start);
+
+		// Managers and backends
+		auto& dispatcher = Dispatcher::getDispatcher();
+		start = std::chrono::steady_clock::now();
+		dispatcher.init();
+		double init = elapsed(start);
+		if (!dispatcher.hasVulkan()) {
+			return EXIT_FAILURE;
+		}
+
+		// First kernel: pipeline creation from the embedded SPIR-V
+		Tensor a = Tensor::fromVector(std::vector<float>(STARTUP_ELEMENTS, 1.0f), { STARTUP_ELEMENTS }).to(TensorLocation::Device);
+		dispatcher.setPreference(BackendPreference::Vulkan);
+		start = std::chrono::steady_clock::now();
+		dispatcher.add(a, a);
+		double firstKernel = elapsed(start);
+
+		std::printf("%.9f %.9f %.9f\n", context, init, firstKernel);
+		dispatcher.destroy();
+
+	} catch (const std::runtime_error& e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+void runStartupBenchmarks(BenchSuite& suite) {
+	const BenchConfig& config = suite.getConfig();
+	const char* names[] = { "startup/context", "startup/dispatcher_init", "startup/first_kernel" };
+	if (!std::ranges::any_of(names, [&](const char* name) { return suite.isSelected(name); })) {
+		return;
+	}
+
+	std::vector<double> samples[3];
+	std::string command = "\"" + config.executable + "\" --startup-child";
+	for (uint32_t i = 0; i < config.warmupRuns + config.timedRuns; i++) {
+		FILE* child = popen(command.c_str(), "r");
+		if (child == nullptr) {
+			throw std::runtime_error("Unable to start " + command);
+		}
+		double times[3];
+		int parsed = std::fscanf(child, "%lf %lf %lf", &times[0], &times[1], &times[2]);
+		if (pclose(child) != 0 || parsed != 3) {
+			std::cerr << "Startup benchmark failed, skipped" << std::endl;
+			return;
+		}
+
+		if (i >= config.warmupRuns) {
+			for (int j = 0; j < 3; j++) {
+				samples[j].push_back(times[j]);
+			}
+		}
+	}
+
+	for (int j = 0; j < 3; j++) {
+		if (suite.isSelected(names[j])) {
+			suite.record({ .name = names[j] }, samples[j]);
+		}
+	}
+}
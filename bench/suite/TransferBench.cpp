@@ -0,0 +1,53 @@
+// Host <-> device bandwidth of the staged copies of the memory manager
+
+#include "BenchSuite.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+void runTransferBenchmarks(BenchSuite& suite) {
+	auto& memMgr = MemoryManager::getManager();
+
+	for (size_t size : { size_t(1) << 16, size_t(1) << 20, size_t(1) << 24 }) {
+		std::vector<uint32_t> data(size / sizeof(uint32_t));
+		std::mt19937 generator(static_cast<uint32_t>(suite.getConfig().seed));
+		for (uint32_t& value : data) {
+			value = generator();
+		}
+		MemoryHandle buffer = memMgr.getBuffer(size, 0);
+
+		suite.measure({
+			.name = "transfer/write/" + std::to_string(size),
+			.work = static_cast<double>(size),
+			.workUnit = "bytes",
+			.run = [&] { memMgr.writeBuffer(buffer, data.data(), size); },
+		});
+		suite.measure({
+			.name = "transfer/read/" + std::to_string(size),
+			.work = static_cast<double>(size),
+			.workUnit = "bytes",
+			.run = [&] { memMgr.readBuffer(buffer, data.data(), size); },
+		});
+
+		memMgr.releaseBuffer(buffer);
+	}
+
+	// Tensor round trip, including the allocation of the destination
+	size_t count = 1 << 22;
+	Tensor host = Tensor::fromVector(std::vector<float>(count, 1.0f), { count });
+	suite.measure({
+		.name = "transfer/tensor_upload/" + std::to_string(count * sizeof(float)),
+		.work = static_cast<double>(count * sizeof(float)),
+		.workUnit = "bytes",
+		.run = [&] { host.to(TensorLocation::Device); },
+	});
+	Tensor device = host.to(TensorLocation::Device);
+	suite.measure({
+		.name = "transfer/tensor_download/" + std::to_string(count * sizeof(float)),
+		.work = static_cast<double>(count * sizeof(float)),
+		.workUnit = "bytes",
+		.run = [&] { device.to(TensorLocation::Host); },
+	});
+}
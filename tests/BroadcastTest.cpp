@@ -0,0 +1,143 @@
+// Verifies the broadcasting of the binary operations on both backends, against a naive reference
+
+#include "OpsTestsCommon.hpp"
+
+
+// Reference: every output coordinate mapped back to the operands
+static std::vector<float> referenceBinary(BinaryOp op, const std::vector<float>& a, const std::vector<size_t>& shapeA,
+                                          const std::vector<float>& b, const std::vector<size_t>& shapeB) {
+    std::vector<size_t> shape = broadcastShapes(shapeA, shapeB);
+    size_t count = 1;
+    for (size_t dim : shape) {
+        count *= dim;
+    }
+
+    auto operandIndex = [&](size_t index, const std::vector<size_t>& operandShape) {
+        size_t result = 0;
+        size_t stride = 1;
+        for (size_t i = 0; i < shape.size(); i++) {
+            size_t dim = shape.size() - 1 - i;
+            size_t coordinate = index % shape[dim];
+            index /= shape[dim];
+            if (i < operandShape.size()) {
+                size_t operandDim = operandShape[operandShape.size() - 1 - i];
+                result += (operandDim == 1 ? 0 : coordinate) * stride;
+                stride *= operandDim;
+            }
+        }
+        return result;
+    };
+
+    std::vector<float> out(count);
+    for (size_t i = 0; i < count; i++) {
+        float x = a[operandIndex(i, shapeA)];
+        float y = b[operandIndex(i, shapeB)];
+        out[i] = op == BinaryOp::Add ? x + y : op == BinaryOp::Sub ? x - y : op == BinaryOp::Mul ? x * y : x / y;
+    }
+    return out;
+}
+
+
+static Tensor run(Dispatcher& dispatcher, BinaryOp op, const Tensor& a, const Tensor& b) {
+    switch (op) {
+        case BinaryOp::Add: return dispatcher.add(a, b);
+        case BinaryOp::Sub: return dispatcher.sub(a, b);
+        case BinaryOp::Mul: return dispatcher.mul(a, b);
+        case BinaryOp::Div: return dispatcher.div(a, b);
+    }
+    return Tensor();
+}
+
+
+int main() {
+    try {
+        // Shape rules
+        assert(broadcastShapes({ 8, 1, 6 }, { 7, 1 }) == std::vector<size_t>({ 8, 7, 6 }));
+        assert(broadcastShapes({ 5 }, {}) == std::vector<size_t>({ 5 }));
+        bool rejected = false;
+        try {
+            broadcastShapes({ 3, 4 }, { 3 });
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+
+        // Collapsed layouts: bias add, row scaling, identical shapes
+        BroadcastLayout bias = BroadcastLayout::create({ 4, 5, 8 }, { 8 }, { 4, 5, 8 });
+        assert(bias.shape == std::vector<size_t>({ 20, 8 }));
+        assert(bias.stridesA == std::vector<size_t>({ 8, 1 }) && bias.stridesB == std::vector<size_t>({ 0, 1 }));
+        BroadcastLayout rows = BroadcastLayout::create({ 6, 10 }, { 6, 1 }, { 6, 10 });
+        assert(rows.stridesB == std::vector<size_t>({ 1, 0 }));
+        assert(BroadcastLayout::create({ 3, 4, 5 }, { 3, 4, 5 }, { 3, 4, 5 }).isContiguous());
+
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+
+        // Vectorizable (inner size multiple of 4) and scalar layouts, broadcast on either side
+        const std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> cases = {
+            { { 300, 64 }, { 64 } },            // Bias add
+            { { 300, 64 }, { 300, 1 } },        // Row normalization
+            { { 257, 33 }, { 33 } },
+            { { 1 }, { 1000, 7 } },             // Scalar
+            { { 9, 1, 12 }, { 5, 1 } },         // Both operands broadcast
+            { { 2, 1, 3, 1, 5, 1, 4 }, { 2, 7, 1, 6, 1, 8, 1 } },
+            { { 1000 }, { 1000 } },
+        };
+
+        std::vector<BackendPreference> preferences = { BackendPreference::Cpu };
+        if (dispatcher.hasVulkan()) {
+            preferences.push_back(BackendPreference::Vulkan);
+        } else {
+            std::cout << "No Vulkan device, CPU backend only" << std::endl;
+        }
+
+        uint32_t seed = 1;
+        for (BackendPreference preference : preferences) {
+            dispatcher.setPreference(preference);
+            for (const auto& [shapeA, shapeB] : cases) {
+                size_t countA = 1, countB = 1;
+                for (size_t dim : shapeA) countA *= dim;
+                for (size_t dim : shapeB) countB *= dim;
+                std::vector<float> a = randomValues(countA, seed++);
+                std::vector<float> b = randomValues(countB, seed++, 0.5f, 2.0f);
+                Tensor ta = Tensor::fromVector(a, shapeA);
+                Tensor tb = Tensor::fromVector(b, shapeB);
+
+                for (BinaryOp op : { BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Div }) {
+                    Tensor out = run(dispatcher, op, ta, tb);
+                    assert(out.getShape() == broadcastShapes(shapeA, shapeB));
+                    assert(allClose(out.toVector(), referenceBinary(op, a, shapeA, b, shapeB)));
+
+                    // Operand order matters for sub and div
+                    assert(allClose(run(dispatcher, op, tb, ta).toVector(), referenceBinary(op, b, shapeB, a, shapeA)));
+                }
+
+                // 16-bit storage, computed in float32
+                if (preference == BackendPreference::Cpu ||
+                    VulkanContext::getContext().getDeviceFeatures()[0].storageBuffer16BitAccess) {
+                    Tensor half = dispatcher.add(dispatcher.cast(ta, DType::Float16), dispatcher.cast(tb, DType::Float16));
+                    assert(half.getDType() == DType::Float16);
+                    assert(allClose(half.toVector(), referenceBinary(BinaryOp::Add, a, shapeA, b, shapeB), 2e-3f));
+                }
+            }
+
+            // Incompatible shapes are rejected before reaching a backend
+            rejected = false;
+            try {
+                dispatcher.add(Tensor::fromVector(randomValues(12, 1), { 3, 4 }), Tensor::fromVector(randomValues(3, 2), { 3 }));
+            } catch (const std::runtime_error&) {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+
+        dispatcher.setPreference(BackendPreference::Auto);
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
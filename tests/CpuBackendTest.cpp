@@ -0,0 +1,113 @@
+// Verifies the CPU backend kernels for every SIMD level supported by the machine
+
+#include "OpsTestsCommon.hpp"
+
+#include <atomic>
+
+#define ODD_SIZE 1003			// Not a multiple of any vector width
+#define LARGE_SIZE (1 << 20)	// Split across the worker threads
+
+
+static void checkElementwise(CpuBackend& backend, size_t count) {
+    std::vector<float> a = randomValues(count, 1);
+    std::vector<float> b = randomValues(count, 2, 0.5f, 2.0f);
+    Tensor ta = Tensor::fromVector(a, { count });
+    Tensor tb = Tensor::fromVector(b, { count });
+    Tensor out = Tensor::empty({ count });
+
+    std::vector<float> expected(count);
+
+    backend.binary(BinaryOp::Add, ta, tb, out);
+    for (size_t i = 0; i < count; i++) expected[i] = a[i] + b[i];
+    assert(allClose(out.toVector(), expected));
+
+    backend.binary(BinaryOp::Sub, ta, tb, out);
+    for (size_t i = 0; i < count; i++) expected[i] = a[i] - b[i];
+    assert(allClose(out.toVector(), expected));
+
+    backend.binary(BinaryOp::Mul, ta, tb, out);
+    for (size_t i = 0; i < count; i++) expected[i] = a[i] * b[i];
+    assert(allClose(out.toVector(), expected));
+
+    backend.binary(BinaryOp::Div, ta, tb, out);
+    for (size_t i = 0; i < count; i++) expected[i] = a[i] / b[i];
+    assert(allClose(out.toVector(), expected));
+
+    backend.unary(UnaryOp::Relu, ta, out);
+    for (size_t i = 0; i < count; i++) expected[i] = std::max(a[i], 0.0f);
+    assert(allClose(out.toVector(), expected));
+
+    backend.unary(UnaryOp::Neg, ta, out);
+    for (size_t i = 0; i < count; i++) expected[i] = -a[i];
+    assert(allClose(out.toVector(), expected));
+
+    backend.unary(UnaryOp::Exp, ta, out);
+    for (size_t i = 0; i < count; i++) expected[i] = std::exp(a[i]);
+    assert(allClose(out.toVector(), expected));
+
+    backend.unary(UnaryOp::Scale, ta, out, 3.0f);
+    for (size_t i = 0; i < count; i++) expected[i] = a[i] * 3.0f;
+    assert(allClose(out.toVector(), expected));
+}
+
+
+static void checkMatmul(CpuBackend& backend, size_t M, size_t K, size_t N) {
+    std::vector<float> a = randomValues(M * K, 3);
+    std::vector<float> b = randomValues(K * N, 4);
+    Tensor out = Tensor::empty({ M, N });
+
+    backend.matmul(Tensor::fromVector(a, { M, K }), Tensor::fromVector(b, { K, N }), out);
+    assert(allClose(out.toVector(), referenceMatmul(a, b, M, K, N), 1e-4f));
+}
+
+
+int main() {
+    try {
+        CpuBackend backend;
+        SimdLevel detected = CpuBackend::detectSimdLevel();
+        std::cout << "SIMD level: " << getSimdLevelName(detected) << ", threads: " << backend.getThreadCount() << std::endl;
+
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Neon, SimdLevel::Avx2, SimdLevel::Avx512 }) {
+            if (!CpuBackend::isSimdLevelSupported(level)) {
+                continue;
+            }
+            backend.setSimdLevel(level);
+            std::cout << "  Checking " << getSimdLevelName(backend.getSimdLevel()) << std::endl;
+
+            checkElementwise(backend, ODD_SIZE);
+            checkElementwise(backend, LARGE_SIZE);
+            checkMatmul(backend, 37, 53, 29);
+            checkMatmul(backend, 128, 300, 65);
+        }
+
+        // Force several workers even on single-core machines
+        CpuBackend threaded(4);
+        checkElementwise(threaded, LARGE_SIZE);
+        checkMatmul(threaded, 128, 300, 65);
+
+        // An exception in a chunk (calling thread or worker) is rethrown once all the chunks are done
+        for (size_t failing : { size_t(0), size_t(LARGE_SIZE - 1) }) {
+            std::atomic<size_t> processed = 0;
+            bool thrown = false;
+            try {
+                threaded.parallelFor(LARGE_SIZE, 1, [&](size_t begin, size_t end) {
+                    if (failing >= begin && failing < end) {
+                        throw std::runtime_error("Chunk failure");
+                    }
+                    processed += end - begin;
+                });
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            assert(thrown);
+            assert(processed == LARGE_SIZE - LARGE_SIZE / threaded.getThreadCount());
+        }
+        checkElementwise(threaded, LARGE_SIZE);	// The workers survived
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+// Verifies that the dispatcher routes the operations and that both backends agree
+
+#include "OpsTestsCommon.hpp"
+
+#define SMALL_SIZE 16
+#define LARGE_SIZE (1 << 20)
+
+
+int main() {
+    try {
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+
+        // Tiny host tensors never go to the GPU
+        Tensor small = Tensor::fromVector(randomValues(SMALL_SIZE, 1), { SMALL_SIZE });
+        dispatcher.add(small, small);
+        assert(dispatcher.getLastBackend() == BackendType::Cpu);
+
+        if (!dispatcher.hasVulkan()) {
+            std::cout << "No Vulkan device, CPU fallback only" << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // Large device tensors stay on the GPU
+        std::vector<float> a = randomValues(LARGE_SIZE, 2);
+        std::vector<float> b = randomValues(LARGE_SIZE, 3, 0.5f, 2.0f);
+        Tensor da = Tensor::fromVector(a, { LARGE_SIZE }, TensorLocation::Device);
+        Tensor db = Tensor::fromVector(b, { LARGE_SIZE }, TensorLocation::Device);
+        Tensor dc = dispatcher.mul(da, db);
+        assert(dispatcher.getLastBackend() == BackendType::Vulkan);
+        assert(!dc.isHost());
+
+        // Both backends give the same results
+        Tensor ha = da.to(TensorLocation::Host);
+        Tensor hb = db.to(TensorLocation::Host);
+        for (BinaryOp op : { BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Div }) {
+            Tensor cpu = Tensor::empty({ LARGE_SIZE });
+            dispatcher.getCpuBackend().binary(op, ha, hb, cpu);
+
+            dispatcher.setPreference(BackendPreference::Vulkan);
+            Tensor gpu = op == BinaryOp::Add ? dispatcher.add(da, db) : op == BinaryOp::Sub ? dispatcher.sub(da, db)
+                       : op == BinaryOp::Mul ? dispatcher.mul(da, db) : dispatcher.div(da, db);
+            assert(allClose(gpu.toVector(), cpu.toVector()));
+        }
+
+        auto cpuUnary = [&](UnaryOp op, float alpha) {
+            Tensor out = Tensor::empty({ LARGE_SIZE });
+            dispatcher.getCpuBackend().unary(op, ha, out, alpha);
+            return out.toVector();
+        };
+        assert(allClose(dispatcher.relu(da).toVector(), cpuUnary(UnaryOp::Relu, 1.0f)));
+        assert(allClose(dispatcher.neg(da).toVector(), cpuUnary(UnaryOp::Neg, 1.0f)));
+        assert(allClose(dispatcher.scale(da, -2.0f).toVector(), cpuUnary(UnaryOp::Scale, -2.0f)));
+        assert(allClose(dispatcher.exp(da).toVector(), cpuUnary(UnaryOp::Exp, 1.0f), 1e-4f));
+
+        // Matrix multiplication with sizes that are not multiples of the tile size
+        size_t M = 70, K = 45, N = 33;
+        std::vector<float> ma = randomValues(M * K, 4);
+        std::vector<float> mb = randomValues(K * N, 5);
+        Tensor product = dispatcher.matmul(Tensor::fromVector(ma, { M, K }), Tensor::fromVector(mb, { K, N }));
+        assert(dispatcher.getLastBackend() == BackendType::Vulkan);
+        assert(allClose(product.toVector(), referenceMatmul(ma, mb, M, K, N), 1e-4f));
+
+        dispatcher.setPreference(BackendPreference::Auto);
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+// Verifies the kernels embedded at build time: every variant is present and looks like a SPIR-V module
+
+#include "VKNP.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+
+int main() {
+    try {
+        auto kernels = getEmbeddedKernels();
+        assert(!kernels.empty());
+        for (const EmbeddedKernel& kernel : kernels) {
+            assert(kernel.code.size() > 5 && kernel.code[0] == 0x07230203);
+            assert(getEmbeddedKernel(kernel.name).data() == kernel.code.data());
+        }
+
+        // One variant per dtype
+        for (DType dtype : { DType::Float32, DType::Float16, DType::BFloat16 }) {
+            for (const char* kernel : { "elementwise_binary", "elementwise_binary_strided", "elementwise_unary", "matmul", "random", "random_fused" }) {
+                assert(!getEmbeddedKernel(std::string(kernel) + "_" + getDTypeSuffix(dtype)).empty());
+            }
+        }
+        assert(!getEmbeddedKernel("elementwise_binary_vec4_f32").empty());
+        assert(!getEmbeddedKernel("radix_sort_u64").empty());
+
+        bool rejected = false;
+        try {
+            getEmbeddedKernel("missing_kernel");
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
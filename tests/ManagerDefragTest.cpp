@@ -0,0 +1,169 @@
+// Verifies that the memory manager defragmentation releases sparse blocks without losing the content of the active buffers
+// By default only the cached buffers move, the active ones only with includeActive
+
+#include "ManagerTestsCommon.hpp"
+
+#include <set>
+#include <vector>
+
+#define DEFRAG_BUFFER_SIZE (8 << 20)	// 8 buffers per memory block
+#define DEFRAG_BUFFER_COUNT 24
+#define DEFRAG_REQUEST_SIZE (24 << 20)	// Larger than any gap left by createSparseBlocks, smaller than the dedicated threshold
+
+
+// Fills 3 blocks with tagged buffers, then frees 2 buffers out of 3 to leave holes in every block
+static std::vector<std::pair<MemoryHandle, uint32_t>> createSparseBlocks(MemoryManager& memMgr) {
+    std::vector<MemoryHandle> handles;
+    for (uint32_t i = 0; i < DEFRAG_BUFFER_COUNT; i++) {
+        MemoryHandle handle = memMgr.getBuffer(DEFRAG_BUFFER_SIZE, 0);
+        std::vector<uint32_t> data(DEFRAG_BUFFER_SIZE / sizeof(uint32_t), i);
+        memMgr.writeBuffer(handle, data.data(), DEFRAG_BUFFER_SIZE);
+        handles.push_back(handle);
+    }
+
+    std::vector<std::pair<MemoryHandle, uint32_t>> kept;
+    for (uint32_t i = 0; i < DEFRAG_BUFFER_COUNT; i++) {
+        if (i % 3 == 0) {
+            kept.push_back({ handles[i], i });
+        } else {
+            memMgr.releaseBuffer(handles[i]);
+        }
+    }
+    memMgr.emptyCache(0);
+    return kept;
+}
+
+
+static void printReport(const char* mode, const DefragmentationReport& report) {
+    std::cout << mode << ": blocks " << report.before.blockCount << " -> " << report.after.blockCount
+              << ", fragmentation: " << report.before.fragmentation() << " -> " << report.after.fragmentation()
+              << ", moved: " << report.movedAllocations << " (" << report.movedBytes << " bytes)" << std::endl;
+}
+
+
+int main() {
+    try {
+        initContextAndManager();
+        auto& memMgr = MemoryManager::getManager();
+        memMgr.emptyCache(0);
+
+        // 1) Default: the active buffers stay in place, their BufferInfo remains valid
+
+        auto kept = createSparseBlocks(memMgr);
+        std::vector<VkBuffer> buffers;
+        for (auto& [handle, tag] : kept) {
+            buffers.push_back(memMgr.getBufferInfo(handle).buffer);
+        }
+
+        DefragmentationReport report = memMgr.defragment(0);
+        printReport("Active buffers, default", report);
+        assert(report.complete);
+        assert(report.movedAllocations == 0 && report.releasedBlocks == 0);
+        for (size_t i = 0; i < kept.size(); i++) {
+            assert(memMgr.getBufferInfo(kept[i].first).buffer == buffers[i]);
+        }
+
+        // Once released, the same buffers are cached and can be compacted
+        std::set<uint64_t> ids;
+        for (auto& [handle, tag] : kept) {
+            memMgr.releaseBuffer(handle);
+            ids.insert(handle.id);
+        }
+
+        report = memMgr.defragment(0);
+        printReport("Cached buffers, default", report);
+        assert(report.complete);
+        assert(report.releasedBlocks > 0);
+        assert(report.after.blockCount < report.before.blockCount);
+        assert(report.after.usedBytes == report.before.usedBytes);
+
+        // The cached buffers are still reused (their content is undefined)
+        std::vector<MemoryHandle> reused;
+        for (size_t i = 0; i < kept.size(); i++) {
+            MemoryHandle handle = memMgr.getBuffer(DEFRAG_BUFFER_SIZE, 0);
+            assert(ids.erase(handle.id) == 1);
+            assert(memMgr.getBufferInfo(handle).size == DEFRAG_BUFFER_SIZE);
+            reused.push_back(handle);
+        }
+        for (const MemoryHandle& handle : reused) {
+            memMgr.releaseBuffer(handle);
+        }
+        memMgr.emptyCache(0);
+        assert(memMgr.getFragmentationStats(0).blockCount == 0);
+
+        // 2) includeActive: the active buffers move as well, first in a time-budgeted slice, then until completion
+
+        kept = createSparseBlocks(memMgr);
+        FragmentationStats initial = memMgr.getFragmentationStats(0);
+        report = memMgr.defragment(0, std::chrono::microseconds(1), true);
+        printReport("Active buffers, includeActive, 1 us slice", report);
+        assert(!report.complete);
+        assert(report.releasedBlocks == 1);
+
+        report = memMgr.defragment(0, std::chrono::microseconds::zero(), true);
+        printReport("Active buffers, includeActive, resumed", report);
+        assert(report.complete);
+        assert(report.after.blockCount < initial.blockCount);
+        assert(report.after.usedBytes == initial.usedBytes);
+
+        // The handles are still valid and the content was preserved
+        for (auto& [handle, tag] : kept) {
+            std::vector<uint32_t> data(DEFRAG_BUFFER_SIZE / sizeof(uint32_t));
+            memMgr.readBuffer(handle, data.data(), DEFRAG_BUFFER_SIZE);
+            assert(data.front() == tag && data.back() == tag);
+            assert(memMgr.getBufferInfo(handle).size == DEFRAG_BUFFER_SIZE);
+            memMgr.releaseBuffer(handle);
+        }
+
+        // Nothing left to compact
+        memMgr.emptyCache(0);
+        assert(memMgr.getFragmentationStats(0).blockCount == 0);
+
+        // 3) Full device: getBuffer doesn't relocate the active buffers, even if the free gaps exceed the request
+
+        kept = createSparseBlocks(memMgr);
+        FragmentationStats stats = memMgr.getFragmentationStats(0);
+        assert(stats.freeBytes > DEFRAG_REQUEST_SIZE && stats.largestFreeRange < DEFRAG_REQUEST_SIZE);
+
+        // Leave less free memory than the request with a dedicated buffer
+        auto& ctx = VulkanContext::getContext();
+        auto [usedMemory, totalMemory] = ctx.getMemoryUsage(ctx.getPhysicalDevices()[0]);
+        MemoryHandle filler = memMgr.getBuffer(totalMemory - usedMemory - DEFRAG_REQUEST_SIZE / 2, 0);
+
+        // The request fails without evicting a cache which can't cover it
+        MemoryHandle cached = memMgr.getBuffer(DEFRAG_BUFFER_SIZE / 8, 0);
+        memMgr.releaseBuffer(cached);
+
+        bool thrown = false;
+        try {
+            memMgr.getBuffer(DEFRAG_REQUEST_SIZE, 0);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Expected error: " << e.what() << std::endl;
+            thrown = true;
+        }
+        assert(thrown);
+
+        MemoryHandle cacheHit = memMgr.getBuffer(DEFRAG_BUFFER_SIZE / 8, 0);
+        assert(cacheHit.id == cached.id);
+        memMgr.releaseBuffer(cacheHit);
+
+        // An explicit compaction of the active buffers releases a block
+        report = memMgr.defragment(0, std::chrono::microseconds::zero(), true);
+        printReport("Full device, includeActive", report);
+        assert(report.releasedBlocks > 0);
+
+        MemoryHandle request = memMgr.getBuffer(DEFRAG_REQUEST_SIZE, 0);
+        memMgr.releaseBuffer(request);
+        memMgr.releaseBuffer(filler);
+        for (auto& [handle, tag] : kept) {
+            memMgr.releaseBuffer(handle);
+        }
+        memMgr.emptyCache(0);
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -5,6 +5,7 @@
 
 int main() {
     try {
+        VulkanContext::setLogicalDevicesPerPhysicalDevice(2);	// For the per-device emptying
         initContextAndManager();
 		auto& ctx = VulkanContext::getContext();
         auto& memMgr = MemoryManager::getManager();
@@ -32,7 +33,23 @@ int main() {
         assert(h4.id == h5.id);	// h3 deleted from cache, h4 reused
 		memMgr.releaseBuffer(h5);
 
-		// 3) Forced cache emptying (not enough memory)
+		// 3) Per-device emptying: the cache of the other devices is kept
+
+        MemoryHandle d0 = memMgr.getBuffer(ALLOCATION_SIZE, 0);
+        MemoryHandle d1 = memMgr.getBuffer(ALLOCATION_SIZE, 1);
+        memMgr.releaseBuffer(d0);
+        memMgr.releaseBuffer(d1);
+
+        memMgr.emptyCache(0, 1);
+        MemoryHandle d0Reused = memMgr.getBuffer(ALLOCATION_SIZE, 0);
+        MemoryHandle d1New = memMgr.getBuffer(ALLOCATION_SIZE, 1);
+        assert(d0Reused.id == d0.id);
+        assert(d1New.id != d1.id);
+        memMgr.releaseBuffer(d0Reused);
+        memMgr.releaseBuffer(d1New);
+        memMgr.emptyCache(0);
+
+		// 4) Forced cache emptying (not enough memory)
 
         VkPhysicalDevice physDevice = ctx.getPhysicalDevices()[0];
         auto [usedMemory, totalMemory] = ctx.getMemoryUsage(physDevice);
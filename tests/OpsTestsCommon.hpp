@@ -0,0 +1,51 @@
+// Common code for the tensor operations tests.
+
+#pragma once
+
+#include "VKNP.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <cmath>
+
+
+inline std::vector<float> randomValues(size_t count, uint32_t seed, float low = -1.0f, float high = 1.0f) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(low, high);
+
+    std::vector<float> values(count);
+    for (float& value : values) {
+        value = distribution(generator);
+    }
+    return values;
+}
+
+
+inline bool allClose(const std::vector<float>& actual, const std::vector<float>& expected, float tolerance = 1e-5f) {
+    if (actual.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < actual.size(); i++) {
+        if (std::fabs(actual[i] - expected[i]) > tolerance * (1.0f + std::fabs(expected[i]))) {
+            std::cerr << "  Mismatch at " << i << ": " << actual[i] << " != " << expected[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+inline std::vector<float> referenceMatmul(const std::vector<float>& a, const std::vector<float>& b, size_t M, size_t K, size_t N) {
+    std::vector<float> c(M * N, 0.0f);
+    for (size_t i = 0; i < M; i++) {
+        for (size_t k = 0; k < K; k++) {
+            for (size_t j = 0; j < N; j++) {
+                c[i * N + j] += a[i * K + k] * b[k * N + j];
+            }
+        }
+    }
+    return c;
+}
@@ -0,0 +1,107 @@
+// Verifies the 16-bit dtypes: conversions, and operations computed in float32 on both backends
+
+#include "OpsTestsCommon.hpp"
+
+#define TEST_SIZE 100003	// Odd number of 16-bit elements
+
+
+static float getTolerance(DType dtype) {
+    return dtype == DType::Float16 ? 2e-3f : dtype == DType::BFloat16 ? 1.6e-2f : 1e-5f;
+}
+
+
+// Round the values to the dtype, as the backends see them
+static std::vector<float> quantize(const std::vector<float>& values, DType dtype) {
+    return Tensor::fromVector(values, { values.size() }, TensorLocation::Host, 0, dtype).toVector();
+}
+
+
+static void checkConversions() {
+    // Exact values
+    assert(floatToHalf(1.0f) == 0x3C00 && halfToFloat(0x3C00) == 1.0f);
+    assert(floatToHalf(-2.0f) == 0xC000);
+    assert(floatToHalf(65504.0f) == 0x7BFF);
+    assert(floatToHalf(1e6f) == 0x7C00);							// Overflow -> infinity
+    assert(halfToFloat(0x0001) == std::ldexp(1.0f, -24));			// Smallest subnormal
+    assert(floatToBFloat16(1.0f) == 0x3F80 && bfloat16ToFloat(0x3F80) == 1.0f);
+    assert(floatToBFloat16(1.00390625f) == 0x3F80);				// Tie rounded to even
+    assert(floatToBFloat16(1.01171875f) == 0x3F82);
+
+    // Every finite half survives a round trip
+    for (uint32_t bits = 0; bits < 0x10000; bits++) {
+        float value = halfToFloat(static_cast<uint16_t>(bits));
+        if (!std::isnan(value)) {
+            assert(floatToHalf(value) == bits);
+        }
+    }
+}
+
+
+static void checkOperations(Dispatcher& dispatcher, DType dtype, TensorLocation location) {
+    float tolerance = getTolerance(dtype);
+    std::vector<float> a = quantize(randomValues(TEST_SIZE, 1), dtype);
+    std::vector<float> b = quantize(randomValues(TEST_SIZE, 2, 0.5f, 2.0f), dtype);
+    Tensor ta = Tensor::fromVector(a, { TEST_SIZE }, location, 0, dtype);
+    Tensor tb = Tensor::fromVector(b, { TEST_SIZE }, location, 0, dtype);
+
+    std::vector<float> expected(TEST_SIZE);
+    Tensor sum = dispatcher.add(ta, tb);
+    assert(sum.getDType() == dtype);
+    for (size_t i = 0; i < TEST_SIZE; i++) expected[i] = a[i] + b[i];
+    assert(allClose(sum.toVector(), expected, tolerance));
+
+    for (size_t i = 0; i < TEST_SIZE; i++) expected[i] = a[i] / b[i];
+    assert(allClose(dispatcher.div(ta, tb).toVector(), expected, tolerance));
+
+    for (size_t i = 0; i < TEST_SIZE; i++) expected[i] = std::exp(a[i]);
+    assert(allClose(dispatcher.exp(ta).toVector(), expected, tolerance));
+
+    // Casts to and from float32
+    Tensor wide = dispatcher.cast(ta, DType::Float32);
+    assert(wide.getDType() == DType::Float32);
+    assert(allClose(wide.toVector(), a, 0.0f));
+    assert(allClose(dispatcher.cast(wide, dtype).toVector(), a, 0.0f));
+
+    // Matrix multiplication accumulated in float32
+    size_t M = 40, K = 300, N = 24;
+    std::vector<float> ma = quantize(randomValues(M * K, 3), dtype);
+    std::vector<float> mb = quantize(randomValues(K * N, 4), dtype);
+    Tensor product = dispatcher.matmul(Tensor::fromVector(ma, { M, K }, location, 0, dtype),
+                                       Tensor::fromVector(mb, { K, N }, location, 0, dtype));
+    assert(allClose(product.toVector(), referenceMatmul(ma, mb, M, K, N), tolerance * 4));
+}
+
+
+int main() {
+    try {
+        checkConversions();
+
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+
+        for (DType dtype : { DType::Float16, DType::BFloat16 }) {
+            std::cout << "Checking " << getDTypeName(dtype) << " on the CPU" << std::endl;
+            dispatcher.setPreference(BackendPreference::Cpu);
+            checkOperations(dispatcher, dtype, TensorLocation::Host);
+        }
+
+        if (dispatcher.hasVulkan() && VulkanContext::getContext().getDeviceFeatures()[0].storageBuffer16BitAccess) {
+            for (DType dtype : { DType::Float16, DType::BFloat16 }) {
+                std::cout << "Checking " << getDTypeName(dtype) << " on the GPU" << std::endl;
+                dispatcher.setPreference(BackendPreference::Vulkan);
+                checkOperations(dispatcher, dtype, TensorLocation::Device);
+            }
+        } else {
+            std::cout << "No device with 16-bit storage buffers, GPU kernels skipped" << std::endl;
+        }
+
+        dispatcher.setPreference(BackendPreference::Auto);
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
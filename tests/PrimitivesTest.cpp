@@ -0,0 +1,178 @@
+// Verifies the device scan, radix sort and compaction primitives against host references
+
+#include "OpsTestsCommon.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+#define SEED 7
+
+
+template <typename T>
+static MemoryHandle upload(const std::vector<T>& values) {
+    auto& memMgr = MemoryManager::getManager();
+    MemoryHandle handle = memMgr.getBuffer(std::max<size_t>(values.size(), 1) * sizeof(T), 0);
+    if (!values.empty()) {
+        memMgr.writeBuffer(handle, values.data(), values.size() * sizeof(T));
+    }
+    return handle;
+}
+
+
+template <typename T>
+static std::vector<T> download(const MemoryHandle& handle, size_t count) {
+    std::vector<T> values(count);
+    if (count > 0) {
+        MemoryManager::getManager().readBuffer(handle, values.data(), count * sizeof(T));
+    }
+    return values;
+}
+
+
+// Sorts the keys with their indices as payloads, and checks the order and the stability against std::stable_sort
+template <typename T, typename Less>
+static void checkSort(const std::vector<T>& keys, SortKeyType keyType, Less less) {
+    std::vector<uint32_t> indices(keys.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::vector<uint32_t> expected = indices;
+    std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return less(keys[a], keys[b]); });
+
+    MemoryHandle keyBuffer = upload(keys);
+    MemoryHandle payloadBuffer = upload(indices);
+    Primitives::radixSort(0, keyBuffer, payloadBuffer, static_cast<uint32_t>(keys.size()), keyType);
+
+    std::vector<T> sorted = download<T>(keyBuffer, keys.size());
+    assert(download<uint32_t>(payloadBuffer, keys.size()) == expected);
+    for (size_t i = 0; i < keys.size(); i++) {
+        assert(std::memcmp(&sorted[i], &keys[expected[i]], sizeof(T)) == 0);
+    }
+
+    // Without payloads
+    MemoryHandle alone = upload(keys);
+    Primitives::radixSort(0, alone, MemoryHandle{}, static_cast<uint32_t>(keys.size()), keyType);
+    assert(std::memcmp(download<T>(alone, keys.size()).data(), sorted.data(), keys.size() * sizeof(T)) == 0);
+
+    MemoryManager::getManager().releaseBuffer(keyBuffer);
+    MemoryManager::getManager().releaseBuffer(payloadBuffer);
+    MemoryManager::getManager().releaseBuffer(alone);
+}
+
+
+int main() {
+    try {
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+        if (!dispatcher.hasVulkan()) {
+            std::cout << "No Vulkan device, nothing to test" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        auto& memMgr = MemoryManager::getManager();
+
+        uint32_t workgroupSize = Primitives::getWorkgroupSize(0);
+        const DeviceLimits& limits = VulkanContext::getContext().getDeviceLimits()[0];
+        assert(workgroupSize <= limits.maxWorkgroupSize && (workgroupSize & (workgroupSize - 1)) == 0);
+        std::cout << "Subgroup size " << limits.subgroupSize << ", workgroup size " << workgroupSize << std::endl;
+
+        // Sizes around the tile size and large enough for a recursive scan of the tile sums
+        uint32_t tileSize = workgroupSize * 4;
+        std::mt19937 generator(SEED);
+        for (uint32_t count : { 1u, 1000u, tileSize, tileSize + 1, 300000u, tileSize * tileSize + 17 }) {
+            std::vector<uint32_t> values(count);
+            for (uint32_t& value : values) {
+                value = generator() % 100;
+            }
+            std::vector<uint32_t> inclusive(count);
+            std::inclusive_scan(values.begin(), values.end(), inclusive.begin());
+            std::vector<uint32_t> exclusive(count);
+            std::exclusive_scan(values.begin(), values.end(), exclusive.begin(), 0u);
+
+            MemoryHandle input = upload(values);
+            MemoryHandle output = memMgr.getBuffer(count * sizeof(uint32_t), 0);
+            Primitives::exclusiveScan(0, input, output, count);
+            assert(download<uint32_t>(output, count) == exclusive);
+
+            // In place
+            Primitives::inclusiveScan(0, input, input, count);
+            assert(download<uint32_t>(input, count) == inclusive);
+
+            memMgr.releaseBuffer(input);
+            memMgr.releaseBuffer(output);
+        }
+
+        // 32-bit keys with many duplicates (stability), over several tiles
+        for (uint32_t count : { 1u, 777u, 100003u }) {
+            std::vector<uint32_t> keys(count);
+            for (uint32_t& key : keys) {
+                key = generator() % 1000 + (generator() % 4 == 0 ? 0xFFFF0000u : 0u);
+            }
+            checkSort(keys, SortKeyType::Uint32, std::less<uint32_t>());
+        }
+
+        // 64-bit keys differing in both halves
+        std::vector<uint64_t> wideKeys(50000);
+        for (uint64_t& key : wideKeys) {
+            key = (static_cast<uint64_t>(generator() % 64) << 40) | (generator() % 5000);
+        }
+        checkSort(wideKeys, SortKeyType::Uint64, std::less<uint64_t>());
+
+        // Float keys, negative zero before positive zero
+        std::vector<float> floatKeys = randomValues(30000, SEED, -1000.0f, 1000.0f);
+        floatKeys[0] = 0.0f;
+        floatKeys[1] = -0.0f;
+        floatKeys[2] = INFINITY;
+        floatKeys[3] = -INFINITY;
+        floatKeys[4] = -1000.5f;
+        checkSort(floatKeys, SortKeyType::Float32, [](float a, float b) {
+            return a < b || (a == b && std::signbit(a) && !std::signbit(b));
+        });
+
+        // Compaction keeps the flagged elements in order, the count stays on the device
+        for (uint32_t count : { 0u, 1u, 5000u, 250001u }) {
+            std::vector<uint32_t> values(count);
+            std::vector<uint32_t> flags(count);
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < count; i++) {
+                values[i] = generator();
+                flags[i] = generator() % 3 == 0 ? generator() | 1u : 0u;
+                if (flags[i] != 0) {
+                    expected.push_back(values[i]);
+                }
+            }
+
+            MemoryHandle input = upload(values);
+            MemoryHandle flagBuffer = upload(flags);
+            MemoryHandle output = memMgr.getBuffer(std::max<size_t>(count, 1) * sizeof(uint32_t), 0);
+            MemoryHandle outputCount = upload(std::vector<uint32_t>{ 12345 });
+            Primitives::compact(0, input, flagBuffer, output, outputCount, count);
+
+            assert(download<uint32_t>(outputCount, 1)[0] == expected.size());
+            assert(download<uint32_t>(output, expected.size()) == expected);
+
+            memMgr.releaseBuffer(input);
+            memMgr.releaseBuffer(flagBuffer);
+            memMgr.releaseBuffer(output);
+            memMgr.releaseBuffer(outputCount);
+        }
+
+        // Undersized buffers are rejected
+        bool rejected = false;
+        MemoryHandle small = memMgr.getBuffer(16, 0);
+        try {
+            Primitives::exclusiveScan(0, small, small, 5);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+        memMgr.releaseBuffer(small);
+
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+// Verifies the counter-based random generator: known answers, reproducibility across backends and offsets, fusion
+
+#include "OpsTestsCommon.hpp"
+
+#define SAMPLE_SIZE (1 << 18)
+#define SEED 0x123456789ABCDEFull
+
+
+static double mean(const std::vector<float>& values) {
+    double sum = 0.0;
+    for (float value : values) {
+        sum += value;
+    }
+    return sum / static_cast<double>(values.size());
+}
+
+
+static double variance(const std::vector<float>& values) {
+    double m = mean(values);
+    double sum = 0.0;
+    for (float value : values) {
+        sum += (value - m) * (value - m);
+    }
+    return sum / static_cast<double>(values.size());
+}
+
+
+int main() {
+    try {
+        // Philox4x32-10 known answers (Random123)
+        assert((philox4x32({ 0, 0, 0, 0 }, { 0, 0 }) == std::array<uint32_t, 4>{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+        assert((philox4x32({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }) ==
+                std::array<uint32_t, 4>{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+
+        // Moments of the distributions
+        std::vector<float> uniform = dispatcher.random({ SAMPLE_SIZE }, RandomSpec::uniform(-2.0f, 4.0f, SEED), TensorLocation::Host).toVector();
+        assert(*std::min_element(uniform.begin(), uniform.end()) >= -2.0f);
+        assert(*std::max_element(uniform.begin(), uniform.end()) < 4.0f);
+        assert(std::fabs(mean(uniform) - 1.0) < 0.02);
+        assert(std::fabs(variance(uniform) - 3.0) < 0.05);
+
+        std::vector<float> normal = dispatcher.random({ SAMPLE_SIZE }, RandomSpec::normal(1.0f, 2.0f, SEED), TensorLocation::Host).toVector();
+        assert(std::fabs(mean(normal) - 1.0) < 0.02);
+        assert(std::fabs(variance(normal) - 4.0) < 0.08);
+
+        std::vector<float> bernoulli = dispatcher.random({ SAMPLE_SIZE }, RandomSpec::bernoulli(0.3f, SEED), TensorLocation::Host).toVector();
+        assert(std::all_of(bernoulli.begin(), bernoulli.end(), [](float v) { return v == 0.0f || v == 1.0f; }));
+        assert(std::fabs(mean(bernoulli) - 0.3) < 0.01);
+
+        // Offsets continue the stream
+        std::vector<float> tail = dispatcher.random({ SAMPLE_SIZE - 1001 }, RandomSpec::normal(1.0f, 2.0f, SEED, 1001), TensorLocation::Host).toVector();
+        assert(std::equal(tail.begin(), tail.end(), normal.begin() + 1001));
+
+        if (!dispatcher.hasVulkan()) {
+            std::cout << "No Vulkan device, CPU generator only" << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // The device produces the same streams, whatever the offset alignment (the last one crosses a 32-bit block boundary)
+        for (uint64_t offset : { 0ull, 3ull, (1ull << 34) - 6 }) {
+            RandomSpec spec = RandomSpec::uniform(-2.0f, 4.0f, SEED, offset);
+            std::vector<float> host = dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Host).toVector();
+            std::vector<float> device = dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Device).toVector();
+            assert(dispatcher.getLastBackend() == BackendType::Vulkan);
+            assert(device == host);
+
+            spec = RandomSpec::bernoulli(0.3f, SEED, offset);
+            assert(dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Device).toVector() ==
+                   dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Host).toVector());
+
+            // Only the precision of the device log / sin / cos differs
+            spec = RandomSpec::normal(1.0f, 2.0f, SEED, offset);
+            assert(allClose(dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Device).toVector(),
+                            dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Host).toVector(), 2e-3f));
+        }
+
+        // Fused dropout matches the explicit mask
+        std::vector<float> values = randomValues(SAMPLE_SIZE, 1);
+        Tensor x = Tensor::fromVector(values, { SAMPLE_SIZE }, TensorLocation::Device);
+        std::vector<float> dropped = dispatcher.dropout(x, 0.25f, SEED, 7).toVector();
+        std::vector<float> mask = dispatcher.random({ SAMPLE_SIZE }, RandomSpec::bernoulli(0.75f, SEED, 7), TensorLocation::Host).toVector();
+        for (size_t i = 0; i < values.size(); i++) {
+            assert(std::fabs(dropped[i] - values[i] * (mask[i] / 0.75f)) <= 1e-6f * (1.0f + std::fabs(values[i])));
+        }
+
+        // 16-bit outputs are the rounded float32 values
+        if (VulkanContext::getContext().getDeviceFeatures()[0].storageBuffer16BitAccess) {
+            RandomSpec spec = RandomSpec::normal(0.0f, 1.0f, SEED);
+            Tensor half = dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Device, 0, DType::Float16);
+            assert(allClose(half.toVector(), dispatcher.random({ SAMPLE_SIZE }, spec, TensorLocation::Host).toVector(), 5e-3f));
+        }
+
+        // Invalid device index
+        bool rejected = false;
+        try {
+            dispatcher.random({ SAMPLE_SIZE }, RandomSpec::uniform(0.0f, 1.0f, SEED), TensorLocation::Device,
+                              VulkanContext::getContext().getDeviceCount(), DType::Float16);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
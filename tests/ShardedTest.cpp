@@ -0,0 +1,111 @@
+// Verifies the sharded tensors and collectives over several logical devices created on the same GPU
+
+#include "OpsTestsCommon.hpp"
+
+#define LOGICAL_DEVICES 3
+
+
+int main() {
+    try {
+        VulkanContext::setLogicalDevicesPerPhysicalDevice(LOGICAL_DEVICES);
+
+        auto& dispatcher = Dispatcher::getDispatcher();
+        dispatcher.init();
+        if (!dispatcher.hasVulkan()) {
+            std::cout << "No Vulkan device, nothing to shard" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        uint32_t deviceCount = VulkanContext::getContext().getDeviceCount();
+        assert(deviceCount % LOGICAL_DEVICES == 0);
+
+        // The configuration is frozen once the context exists
+        bool rejected = false;
+        try {
+            VulkanContext::setLogicalDevicesPerPhysicalDevice(1);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+
+        // Split along both axes and gather back (10 rows over 3 devices: 3, 3, 4)
+        std::vector<float> values = randomValues(10 * 7, 1);
+        Tensor tensor = Tensor::fromVector(values, { 10, 7 });
+        for (size_t axis : { 0, 1 }) {
+            ShardedTensor sharded = ShardedTensor::split(tensor, axis, { 0, 1, 2 });
+            assert(sharded.getShardCount() == 3);
+            assert(sharded.getShape() == tensor.getShape());
+            assert(sharded.getDeviceIndices() == std::vector<uint32_t>({ 0, 1, 2 }));
+            assert(sharded.gather().toVector() == values);
+        }
+        assert(ShardedTensor::split(tensor, 0, { 0, 1, 2 }).getShard(2).getShape() == std::vector<size_t>({ 4, 7 }));
+
+        // Short axes don't produce empty shards
+        assert(ShardedTensor::split(Tensor::fromVector({ 1.0f, 2.0f }, { 2 }), 0, { 0, 1, 2 }).getShardCount() == 2);
+
+        // Elementwise operations run shard by shard
+        std::vector<float> other = randomValues(10 * 7, 2, 0.5f, 2.0f);
+        ShardedTensor sa = ShardedTensor::split(tensor, 0);
+        ShardedTensor sb = ShardedTensor::split(Tensor::fromVector(other, { 10, 7 }), 0);
+        std::vector<float> expected(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            expected[i] = values[i] * other[i];
+        }
+        assert(allClose(dispatcher.mul(sa, sb).gather().toVector(), expected));
+        assert(dispatcher.getLastBackend() == BackendType::Vulkan);
+
+        std::vector<float> relu(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            relu[i] = std::max(values[i], 0.0f);
+        }
+        assert(allClose(dispatcher.relu(sa).gather().toVector(), relu));
+
+        // Misaligned operands are rejected
+        rejected = false;
+        try {
+            dispatcher.add(sa, ShardedTensor::split(tensor, 1));
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+
+        // Matrix multiplication: data parallel (rows), model parallel (columns) and inner dimension split
+        size_t M = 37, K = 50, N = 19;
+        std::vector<float> ma = randomValues(M * K, 3);
+        std::vector<float> mb = randomValues(K * N, 4);
+        std::vector<float> reference = referenceMatmul(ma, mb, M, K, N);
+        Tensor a = Tensor::fromVector(ma, { M, K });
+        Tensor b = Tensor::fromVector(mb, { K, N });
+
+        ShardedTensor rows = dispatcher.matmul(ShardedTensor::split(a, 0), ShardedTensor::replicate(b));
+        assert(rows.getLayout() == ShardLayout::Split && rows.getAxis() == 0);
+        assert(allClose(rows.gather().toVector(), reference, 1e-4f));
+
+        ShardedTensor columns = dispatcher.matmul(ShardedTensor::replicate(a), ShardedTensor::split(b, 1));
+        assert(columns.getLayout() == ShardLayout::Split && columns.getAxis() == 1);
+        assert(allClose(columns.gather().toVector(), reference, 1e-4f));
+
+        ShardedTensor partials = dispatcher.matmul(ShardedTensor::split(a, 1), ShardedTensor::split(b, 0));
+        assert(partials.getLayout() == ShardLayout::Partial);
+        ShardedTensor reduced = dispatcher.allReduce(partials);
+        assert(reduced.getLayout() == ShardLayout::Replicated);
+        assert(reduced.getShardCount() == deviceCount);
+        for (const Tensor& replica : reduced.getShards()) {
+            assert(allClose(replica.toVector(), reference, 1e-4f));
+        }
+
+        // All-gather leaves the whole tensor on every device
+        ShardedTensor gathered = dispatcher.allGather(rows);
+        assert(gathered.getLayout() == ShardLayout::Replicated);
+        for (const Tensor& replica : gathered.getShards()) {
+            assert(allClose(replica.toVector(), reference, 1e-4f));
+        }
+
+        dispatcher.destroy();
+
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}